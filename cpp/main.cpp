@@ -2,8 +2,15 @@
 
 #include <algorithm>
 #include <array>
+#include <atomic>
+#include <bit>
+#include <cerrno>
+#include <charconv>
 #include <chrono>
+#include <csignal>
 #include <cmath>
+#include <cstdlib>
+#include <cstring>
 #include <deque>
 #include <exception>
 #include <filesystem>
@@ -11,9 +18,15 @@
 #include <functional>
 #include <iomanip>
 #include <iostream>
+#include <map>
 #include <memory>
+#include <memory_resource>
+#include <numeric>
+#include <mutex>
+#include <new>
 #include <optional>
 #include <queue>
+#include <random>
 #include <sstream>
 #include <stack>
 #include <string>
@@ -34,115 +47,1538 @@ extern "C" {
 #include "libbase64.h"
 }
 
+#include <cxxabi.h>
+#include <dlfcn.h>
+#include <execinfo.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/mman.h>
+#include <sys/resource.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/time.h>
+#include <sys/un.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#if defined(__linux__)
+#include <elf.h>
+#include <link.h>
+#include <linux/perf_event.h>
+#include <malloc.h>
+#include <sched.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#elif defined(__APPLE__)
+#include <malloc/malloc.h>
+#include <sys/sysctl.h>
+#endif
+
 namespace fs = std::filesystem;
 using json = nlohmann::json;
 
-json CONFIG;
+// Benchmark configuration, parsed once with simdjson into one Section per
+// config entry, kept in file order. Field names are interned to small ids
+// shared by all sections, so a lookup is a scan over a handful of ints.
+class Config {
+public:
+  using Value = std::variant<int64_t, double, bool, std::string>;
+
+  struct Section {
+    std::string name;
+    std::vector<std::pair<int, Value>> fields;
+
+    const Value *get(int key) const {
+      for (const auto &[k, v] : fields) {
+        if (k == key) {
+          return &v;
+        }
+      }
+      return nullptr;
+    }
+
+    void set(int key, Value value) {
+      for (auto &[k, v] : fields) {
+        if (k == key) {
+          v = std::move(value);
+          return;
+        }
+      }
+      fields.emplace_back(key, std::move(value));
+    }
+  };
+
+private:
+  static inline std::vector<std::string> key_names;
+  static inline std::unordered_map<std::string, int> key_ids;
+  static inline std::vector<Section> sections;
+  static inline std::unordered_map<std::string, size_t> by_name;
+  static inline int64_t parse_ns = 0;
+
+public:
+  // Id of a field name, interning it on first use.
+  static int key(const std::string &field) {
+    auto [it, inserted] =
+        key_ids.emplace(field, static_cast<int>(key_names.size()));
+    if (inserted) {
+      key_names.push_back(field);
+    }
+    return it->second;
+  }
+
+  // Id of a field name, or -1 if no section has it; never interns, so
+  // lookups are safe from any thread.
+  static int find_key(const std::string &field) {
+    auto it = key_ids.find(field);
+    return it == key_ids.end() ? -1 : it->second;
+  }
+
+  static const std::string &key_name(int key) { return key_names[key]; }
+
+  static const std::vector<Section> &all() { return sections; }
+
+  static int64_t load_ns() { return parse_ns; }
+
+  static Section *find(const std::string &name) {
+    auto it = by_name.find(name);
+    return it == by_name.end() ? nullptr : &sections[it->second];
+  }
+
+  // Section for `name`, created empty if the config has none.
+  static Section &section(const std::string &name) {
+    if (Section *found = find(name)) {
+      return *found;
+    }
+    by_name.emplace(name, sections.size());
+    sections.push_back({name, {{key("name"), name}}});
+    return sections.back();
+  }
+
+  // Index of the section for `name`, or -1. Sections are only appended
+  // until the next load(), so the index can be kept and reused.
+  static int section_id(const std::string &name) {
+    auto it = by_name.find(name);
+    return it == by_name.end() ? -1 : static_cast<int>(it->second);
+  }
+
+  static const Value *get(int section, int key) {
+    return section >= 0 && key >= 0 ? sections[section].get(key) : nullptr;
+  }
+
+  static const Value *get(const std::string &name, const std::string &field) {
+    return get(section_id(name), find_key(field));
+  }
+
+  static bool load(const std::string &filename) {
+    int64_t start = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                        std::chrono::steady_clock::now().time_since_epoch())
+                        .count();
+    sections.clear();
+    by_name.clear();
+
+    simdjson::dom::parser parser;
+    simdjson::dom::element doc;
+    auto error = parser.load(filename).get(doc);
+    if (error == simdjson::IO_ERROR) {
+      std::cerr << "Cannot open config file: " << filename << std::endl;
+      return false;
+    }
+    simdjson::dom::array items;
+    if (!error) {
+      error = doc.get_array().get(items);
+    }
+    if (error) {
+      std::cerr << "Error parsing JSON config: "
+                << simdjson::error_message(error) << std::endl;
+      return false;
+    }
+
+    for (simdjson::dom::element item : items) {
+      simdjson::dom::object obj;
+      std::string_view name;
+      if (item.get_object().get(obj) || obj["name"].get_string().get(name)) {
+        std::cerr << "Config entry without a name skipped" << std::endl;
+        continue;
+      }
+      Section &sec = section(std::string(name));
+      for (auto field : obj) {
+        int k = key(std::string(field.key));
+        switch (field.value.type()) {
+        case simdjson::dom::element_type::INT64:
+          sec.set(k, int64_t(field.value));
+          break;
+        case simdjson::dom::element_type::UINT64:
+          sec.set(k, static_cast<int64_t>(uint64_t(field.value)));
+          break;
+        case simdjson::dom::element_type::DOUBLE:
+          sec.set(k, double(field.value));
+          break;
+        case simdjson::dom::element_type::BOOL:
+          sec.set(k, bool(field.value));
+          break;
+        case simdjson::dom::element_type::STRING:
+          sec.set(k, std::string(std::string_view(field.value)));
+          break;
+        default:
+          std::cerr << "Config field " << sec.name << "." << field.key
+                    << " is not a scalar, skipped" << std::endl;
+        }
+      }
+    }
+
+    parse_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                   std::chrono::steady_clock::now().time_since_epoch())
+                   .count() -
+               start;
+    return true;
+  }
+
+  static json to_json(const Value &value) {
+    return std::visit([](const auto &v) { return json(v); }, value);
+  }
+
+  static json to_json(const std::string &name) {
+    json out = json::object();
+    if (const Section *sec = find(name)) {
+      for (const auto &[k, v] : sec->fields) {
+        out[key_names[k]] = to_json(v);
+      }
+    }
+    return out;
+  }
+
+  // Scalar JSON value (e.g. an override received by --serve) as a Value.
+  static std::optional<Value> from_json(const json &value) {
+    if (value.is_number_integer()) {
+      return value.get<int64_t>();
+    }
+    if (value.is_number()) {
+      return value.get<double>();
+    }
+    if (value.is_boolean()) {
+      return value.get<bool>();
+    }
+    if (value.is_string()) {
+      return value.get<std::string>();
+    }
+    return std::nullopt;
+  }
+};
+
+// Ids of the config fields benchmarks read, interned once at startup so
+// config_val() compares ints instead of hashing field names.
+struct ConfigKey {
+  static inline const int ITERATIONS = Config::key("iterations");
+  static inline const int CHECKSUM = Config::key("checksum");
+  static inline const int WARMUP_ITERATIONS = Config::key("warmup_iterations");
+  static inline const int AMOUNT = Config::key("amount");
+  static inline const int DEPTH = Config::key("depth");
+  static inline const int CUTOFF = Config::key("cutoff");
+  static inline const int PROGRAM = Config::key("program");
+  static inline const int WARMUP_PROGRAM = Config::key("warmup_program");
+  static inline const int N = Config::key("n");
+  static inline const int W = Config::key("w");
+  static inline const int H = Config::key("h");
+  static inline const int SIZE = Config::key("size");
+  static inline const int COORDS = Config::key("coords");
+  static inline const int LIMIT = Config::key("limit");
+  static inline const int WORDS = Config::key("words");
+  static inline const int WORD_LEN = Config::key("word_len");
+  static inline const int VERTICES = Config::key("vertices");
+  static inline const int JUMPS = Config::key("jumps");
+  static inline const int JUMP_LEN = Config::key("jump_len");
+  static inline const int VALUES = Config::key("values");
+  static inline const int OPERATIONS = Config::key("operations");
+  static inline const int COUNT = Config::key("count");
+  static inline const int LINES_COUNT = Config::key("lines_count");
+  static inline const int ROWS = Config::key("rows");
+};
+
+struct Options {
+  bool stats = false;
+  bool perf = false;
+  bool alloc = false;
+  bool fork = false;
+  std::string json_path;
+  std::string csv_path;
+  std::string baseline_path;
+  int64_t min_samples = 0;
+  bool adaptive = false;
+  double target_ci = 0.01;
+  double budget = 10.0;
+  std::string sweep_field;
+  int64_t sweep_from = 0;
+  int64_t sweep_to = 0;
+  double sweep_factor = 2.0;
+  int threads = 0;
+  int thread_sweep = 0;
+  int jobs = 0;
+  int rate = 0;
+  std::string profile_dir;
+  std::string trace_path;
+  std::string cache_dir;
+  std::string serve_path;
+  std::vector<std::string> ab;
+};
+
+Options OPTIONS;
+
+// Time from entering main() until the config is loaded and the first
+// benchmark can start.
+int64_t STARTUP_NS = 0;
+
+class Helper {
+private:
+  static const int64_t IM = 139968;
+  static const int64_t IA = 3877;
+  static const int64_t IC = 29573;
+
+  static thread_local int64_t last;
+
+  // Maps state x to the state n draws later, composing the affine step
+  // x -> IA * x + IC (mod IM) by squaring so the jump costs O(log n).
+  static int64_t jump(int64_t state, uint64_t n) {
+    int64_t mul = 1, add = 0;
+    int64_t step_mul = IA, step_add = IC;
+    while (n > 0) {
+      if (n & 1) {
+        mul = (mul * step_mul) % IM;
+        add = (add * step_mul + step_add) % IM;
+      }
+      step_add = (step_add * step_mul + step_add) % IM;
+      step_mul = (step_mul * step_mul) % IM;
+      n >>= 1;
+    }
+    return (state * mul + add) % IM;
+  }
+
+public:
+  static constexpr size_t FILL_CHUNK = 1 << 14;
+
+  static void reset() { last = 42; }
+
+  static int64_t state() { return last; }
+  static void set_state(int64_t state) { last = state; }
+
+  // Advances the generator as if next_int/next_float were called n times.
+  static void skip(uint64_t n) { last = jump(last, n); }
+
+  static size_t fill_chunks(size_t count) {
+    return (count + FILL_CHUNK - 1) / FILL_CHUNK;
+  }
+
+  // Runs body(chunk, begin, end) over [0, count) in FILL_CHUNK pieces, where
+  // every item consumes exactly draws_per_item values from the generator.
+  // Each worker jumps its own (thread_local) generator to the start of the
+  // chunk it picks up, so the data and the final state are bit-identical to
+  // a serial loop; inputs that fit in a single chunk stay on this thread.
+  template <typename F>
+  static void parallel_fill(size_t count, uint64_t draws_per_item, F body) {
+    size_t chunks = fill_chunks(count);
+    size_t workers = std::min<size_t>(
+        std::max(1u, std::thread::hardware_concurrency()), chunks);
+    if (workers < 2) {
+      for (size_t c = 0; c < chunks; c++) {
+        body(c, c * FILL_CHUNK, std::min(count, (c + 1) * FILL_CHUNK));
+      }
+      return;
+    }
+
+    int64_t start = last;
+    std::atomic<size_t> next{0};
+    std::vector<std::thread> pool;
+    pool.reserve(workers);
+    for (size_t w = 0; w < workers; w++) {
+      pool.emplace_back([&]() {
+        for (size_t c; (c = next.fetch_add(1)) < chunks;) {
+          size_t begin = c * FILL_CHUNK;
+          last = jump(start, begin * draws_per_item);
+          body(c, begin, std::min(count, begin + FILL_CHUNK));
+        }
+      });
+    }
+    for (auto &t : pool) {
+      t.join();
+    }
+    last = jump(start, count * draws_per_item);
+  }
+
+  static int64_t now_ns() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+               std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+  }
+
+  static int32_t next_int(int32_t max) {
+    last = (last * IA + IC) % IM;
+    return static_cast<int32_t>((last * max) / IM);
+  }
+
+  static int32_t next_int(int32_t from, int32_t to) {
+    return next_int(to - from + 1) + from;
+  }
+
+  static double next_float(double max = 1.0) {
+    last = (last * IA + IC) % IM;
+    return max * static_cast<double>(last) / IM;
+  }
+
+  static uint32_t checksum(const std::string &v) {
+    uint32_t hash = 5381;
+    for (char c : v) {
+      hash = ((hash << 5) + hash) + static_cast<uint8_t>(c);
+    }
+    return hash;
+  }
+
+  static uint32_t checksum(const std::vector<uint8_t> &v) {
+    uint32_t hash = 5381;
+    for (uint8_t byte : v) {
+      hash = ((hash << 5) + hash) + byte;
+    }
+    return hash;
+  }
+
+  static uint32_t checksum_f64(double v) {
+    std::ostringstream oss;
+    oss << std::fixed << std::setprecision(7) << v;
+    return Helper::checksum(oss.str());
+  }
+
+  // Field `key` of config section `section` (see Config::section_id), or
+  // nullopt when it is missing or not of a matching type.
+  static std::optional<int64_t> config_i64(int section, int key) {
+    const Config::Value *value = Config::get(section, key);
+    if (value) {
+      if (auto i = std::get_if<int64_t>(value)) {
+        return *i;
+      }
+      if (auto d = std::get_if<double>(value)) {
+        return static_cast<int64_t>(*d);
+      }
+      if (auto b = std::get_if<bool>(value)) {
+        return *b;
+      }
+    }
+    return std::nullopt;
+  }
+
+  static std::optional<std::string> config_s(int section, int key) {
+    const Config::Value *value = Config::get(section, key);
+    if (value) {
+      if (auto str = std::get_if<std::string>(value)) {
+        return *str;
+      }
+    }
+    return std::nullopt;
+  }
+};
+
+thread_local int64_t Helper::last = 42;
+
+// Two-sided 95% Student t quantile for `df` degrees of freedom: exact
+// values below 30, where the expansion is too low (3.7% at df = 3), and the
+// Cornish-Fisher expansion around the normal quantile above (within 0.005%).
+double t_quantile_95(double df) {
+  static constexpr double TABLE[] = {
+      12.7062, 4.3027, 3.1824, 2.7764, 2.5706, 2.4469, 2.3646, 2.3060,
+      2.2622,  2.2281, 2.2010, 2.1788, 2.1604, 2.1448, 2.1314, 2.1199,
+      2.1098,  2.1009, 2.0930, 2.0860, 2.0796, 2.0739, 2.0687, 2.0639,
+      2.0595,  2.0555, 2.0518, 2.0484, 2.0452};
+  if (df < 30.0) {
+    return TABLE[std::clamp(static_cast<int>(df), 1, 29) - 1];
+  }
+  const double z = 1.959964;
+  double z3 = z * z * z;
+  double z5 = z3 * z * z;
+  return z + (z3 + z) / (4.0 * df) +
+         (5.0 * z5 + 16.0 * z3 + 3.0 * z) / (96.0 * df * df);
+}
+
+// HDR-style latency histogram: values below 2^(SUB_BITS+1) are stored
+// exactly, above that every power-of-two range is split into 2^SUB_BITS
+// linear buckets, so any recorded value is reproduced within ~0.1%.
+class LatencyHistogram {
+private:
+  static constexpr int SUB_BITS = 10;
+  static constexpr int64_t SUB_COUNT = int64_t(1) << SUB_BITS;
+
+  std::vector<int64_t> counts;
+  int64_t total = 0;
+  int64_t min_val = 0;
+  int64_t max_val = 0;
+  double mean_val = 0.0;
+  double m2 = 0.0;
+
+  static size_t index_of(int64_t v) {
+    if (v < 2 * SUB_COUNT) {
+      return static_cast<size_t>(v);
+    }
+    int shift = std::bit_width(static_cast<uint64_t>(v)) - 1 - SUB_BITS;
+    int64_t sub = (v >> shift) - SUB_COUNT;
+    return static_cast<size_t>(2 * SUB_COUNT + (shift - 1) * SUB_COUNT + sub);
+  }
+
+  static int64_t value_of(size_t idx) {
+    int64_t i = static_cast<int64_t>(idx);
+    if (i < 2 * SUB_COUNT) {
+      return i;
+    }
+    int shift = static_cast<int>((i - 2 * SUB_COUNT) / SUB_COUNT) + 1;
+    int64_t sub = (i - 2 * SUB_COUNT) % SUB_COUNT + SUB_COUNT;
+    return sub << shift;
+  }
+
+public:
+  void record(int64_t v) {
+    if (v < 0) {
+      v = 0;
+    }
+    size_t idx = index_of(v);
+    if (idx >= counts.size()) {
+      counts.resize(idx + 1, 0);
+    }
+    counts[idx]++;
+
+    if (total == 0 || v < min_val) {
+      min_val = v;
+    }
+    if (total == 0 || v > max_val) {
+      max_val = v;
+    }
+    total++;
+    double delta = static_cast<double>(v) - mean_val;
+    mean_val += delta / static_cast<double>(total);
+    m2 += delta * (static_cast<double>(v) - mean_val);
+  }
+
+  void reset() { *this = LatencyHistogram(); }
+
+  int64_t count() const { return total; }
+  int64_t min() const { return min_val; }
+  int64_t max() const { return max_val; }
+  double mean() const { return mean_val; }
+
+  double stddev() const {
+    return total > 1 ? std::sqrt(m2 / static_cast<double>(total - 1)) : 0.0;
+  }
+
+  double cv() const { return mean_val > 0.0 ? stddev() / mean_val : 0.0; }
+
+  int64_t percentile(double p) const {
+    if (total == 0) {
+      return 0;
+    }
+    int64_t rank = static_cast<int64_t>(std::ceil(p / 100.0 * total));
+    rank = std::clamp<int64_t>(rank, 1, total);
+    int64_t seen = 0;
+    for (size_t i = 0; i < counts.size(); i++) {
+      seen += counts[i];
+      if (seen >= rank) {
+        return std::clamp(value_of(i), min_val, max_val);
+      }
+    }
+    return max_val;
+  }
+};
+
+std::string format_ns(int64_t ns) {
+  std::ostringstream oss;
+  oss << std::fixed << std::setprecision(3);
+  if (ns < 1'000) {
+    oss << std::setprecision(0) << static_cast<double>(ns) << "ns";
+  } else if (ns < 1'000'000) {
+    oss << ns / 1e3 << "us";
+  } else if (ns < 1'000'000'000) {
+    oss << ns / 1e6 << "ms";
+  } else {
+    oss << ns / 1e9 << "s";
+  }
+  return oss.str();
+}
+
+// Allocation accounting for --alloc. The global operator new/delete below
+// always route through here but only touch the counters once enabled; sizes
+// come from the allocator itself so frees are matched without a header.
+class AllocStats {
+public:
+  struct Phase {
+    int64_t count = 0;
+    int64_t bytes = 0;
+    int64_t peak = 0;
+  };
+
+private:
+  static inline std::atomic<bool> enabled{false};
+  static inline std::atomic<int64_t> count{0};
+  static inline std::atomic<int64_t> bytes{0};
+  static inline std::atomic<int64_t> live{0};
+  static inline std::atomic<int64_t> peak{0};
+  static inline int64_t phase_base = 0;
+
+  static int64_t usable_size(void *p) {
+#if defined(__linux__)
+    return static_cast<int64_t>(malloc_usable_size(p));
+#elif defined(__APPLE__)
+    return static_cast<int64_t>(malloc_size(p));
+#else
+    (void)p;
+    return 0;
+#endif
+  }
+
+public:
+  static void enable() { enabled.store(true); }
+  static bool is_enabled() { return enabled.load(std::memory_order_relaxed); }
+
+  static void on_alloc(void *p) {
+    if (!is_enabled()) {
+      return;
+    }
+    int64_t size = usable_size(p);
+    count.fetch_add(1, std::memory_order_relaxed);
+    bytes.fetch_add(size, std::memory_order_relaxed);
+    int64_t now = live.fetch_add(size, std::memory_order_relaxed) + size;
+    int64_t prev = peak.load(std::memory_order_relaxed);
+    while (now > prev &&
+           !peak.compare_exchange_weak(prev, now, std::memory_order_relaxed)) {
+    }
+  }
+
+  static void on_free(void *p) {
+    if (p != nullptr && is_enabled()) {
+      live.fetch_sub(usable_size(p), std::memory_order_relaxed);
+    }
+  }
+
+  static void begin_phase() {
+    count.store(0);
+    bytes.store(0);
+    phase_base = live.load();
+    peak.store(phase_base);
+  }
+
+  static Phase end_phase() {
+    return {count.load(), bytes.load(), peak.load() - phase_base};
+  }
+};
+
+void *operator new(size_t size) {
+  void *p = std::malloc(size > 0 ? size : 1);
+  if (p == nullptr) {
+    throw std::bad_alloc();
+  }
+  AllocStats::on_alloc(p);
+  return p;
+}
+
+void *operator new[](size_t size) { return ::operator new(size); }
+
+void operator delete(void *p) noexcept {
+  AllocStats::on_free(p);
+  std::free(p);
+}
+
+void operator delete[](void *p) noexcept { ::operator delete(p); }
+
+void operator delete(void *p, size_t) noexcept { ::operator delete(p); }
+
+void operator delete[](void *p, size_t) noexcept { ::operator delete(p); }
+
+// GMP allocates limbs with malloc directly; --alloc installs these through
+// mp_set_memory_functions so mpz temporaries are counted like operator new.
+void *gmp_alloc(size_t size) {
+  void *p = std::malloc(size);
+  if (p == nullptr) {
+    std::abort();
+  }
+  AllocStats::on_alloc(p);
+  return p;
+}
+
+void *gmp_realloc(void *p, size_t, size_t new_size) {
+  AllocStats::on_free(p);
+  void *q = std::realloc(p, new_size);
+  if (q == nullptr) {
+    std::abort();
+  }
+  AllocStats::on_alloc(q);
+  return q;
+}
+
+void gmp_free(void *p, size_t) {
+  AllocStats::on_free(p);
+  std::free(p);
+}
+
+std::string format_count(double v) {
+  std::ostringstream oss;
+  oss << std::fixed << std::setprecision(2);
+  if (v < 1e3) {
+    oss << v;
+  } else if (v < 1e6) {
+    oss << v / 1e3 << "K";
+  } else if (v < 1e9) {
+    oss << v / 1e6 << "M";
+  } else {
+    oss << v / 1e9 << "G";
+  }
+  return oss.str();
+}
+
+std::string format_bytes(double bytes) {
+  std::ostringstream oss;
+  oss << std::fixed << std::setprecision(1);
+  if (bytes < 1024) {
+    oss << std::setprecision(bytes == std::floor(bytes) ? 0 : 2) << bytes
+        << "B";
+  } else if (bytes < 1024 * 1024) {
+    oss << bytes / 1024.0 << "KB";
+  } else {
+    oss << bytes / (1024.0 * 1024.0) << "MB";
+  }
+  return oss.str();
+}
+
+// Hardware counters for the calling thread (and threads it spawns) via
+// perf_event_open. Each event is opened on its own so that a PMU lacking one
+// of them, or a kernel refusing access, only drops that event; values are
+// scaled when the kernel had to multiplex counters.
+class PerfCounters {
+public:
+  enum Event {
+    CYCLES,
+    INSTRUCTIONS,
+    L1D_MISSES,
+    LLC_MISSES,
+    BRANCH_MISSES,
+    DTLB_MISSES,
+    EVENT_COUNT
+  };
+
+private:
+  std::array<int, EVENT_COUNT> fds;
+  std::array<double, EVENT_COUNT> values{};
+  std::string error;
+
+#ifdef __linux__
+  static int open_event(uint32_t type, uint64_t config) {
+    perf_event_attr attr{};
+    attr.size = sizeof(attr);
+    attr.type = type;
+    attr.config = config;
+    attr.disabled = 1;
+    attr.inherit = 1;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    attr.read_format =
+        PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+    return static_cast<int>(syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0));
+  }
+
+  static uint64_t cache_miss(uint64_t cache) {
+    return cache | (PERF_COUNT_HW_CACHE_OP_READ << 8) |
+           (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+  }
+#endif
+
+public:
+  PerfCounters() { fds.fill(-1); }
+
+  PerfCounters(const PerfCounters &) = delete;
+  PerfCounters &operator=(const PerfCounters &) = delete;
+
+  ~PerfCounters() {
+#ifdef __linux__
+    for (int fd : fds) {
+      if (fd >= 0) {
+        close(fd);
+      }
+    }
+#endif
+  }
+
+  static const char *event_name(int e) {
+    static const char *names[EVENT_COUNT] = {
+        "cycles", "instructions", "l1d-miss", "llc-miss", "br-miss",
+        "dtlb-miss"};
+    return names[e];
+  }
+
+  bool open() {
+#ifdef __linux__
+    fds[CYCLES] = open_event(PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES);
+    if (fds[CYCLES] < 0) {
+      error = std::strerror(errno);
+    }
+    fds[INSTRUCTIONS] =
+        open_event(PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS);
+    fds[L1D_MISSES] =
+        open_event(PERF_TYPE_HW_CACHE, cache_miss(PERF_COUNT_HW_CACHE_L1D));
+    fds[LLC_MISSES] =
+        open_event(PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES);
+    fds[BRANCH_MISSES] =
+        open_event(PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES);
+    fds[DTLB_MISSES] =
+        open_event(PERF_TYPE_HW_CACHE, cache_miss(PERF_COUNT_HW_CACHE_DTLB));
+#else
+    error = "perf_event_open is Linux only";
+#endif
+    return any();
+  }
+
+  bool any() const {
+    return std::any_of(fds.begin(), fds.end(), [](int fd) { return fd >= 0; });
+  }
+
+  bool available(int e) const { return fds[e] >= 0; }
+  double value(int e) const { return values[e]; }
+  const std::string &last_error() const { return error; }
+
+  void start() {
+#ifdef __linux__
+    for (int fd : fds) {
+      if (fd >= 0) {
+        ioctl(fd, PERF_EVENT_IOC_RESET, 0);
+        ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);
+      }
+    }
+#endif
+  }
+
+  void stop() {
+#ifdef __linux__
+    for (int e = 0; e < EVENT_COUNT; e++) {
+      if (fds[e] >= 0) {
+        ioctl(fds[e], PERF_EVENT_IOC_DISABLE, 0);
+      }
+    }
+    for (int e = 0; e < EVENT_COUNT; e++) {
+      uint64_t buf[3] = {0, 0, 0};
+      if (fds[e] < 0 || read(fds[e], buf, sizeof(buf)) != sizeof(buf)) {
+        continue;
+      }
+      double scale = buf[2] > 0 ? static_cast<double>(buf[1]) /
+                                      static_cast<double>(buf[2])
+                                : 0.0;
+      values[e] = static_cast<double>(buf[0]) * scale;
+    }
+#endif
+  }
+};
+
+// In-process sampling profiler for --profile. While active, ITIMER_PROF
+// delivers SIGPROF every ~1ms of consumed CPU time (any thread) and the
+// handler stores a backtrace() into a preallocated slot; symbolisation with
+// dladdr() happens afterwards. Functions that are not in the dynamic symbol
+// table are written as binary+offset (link with -rdynamic to get names, or
+// resolve them with addr2line).
+class Profiler {
+private:
+  static constexpr int HZ = 997;
+  static constexpr int MAX_DEPTH = 64;
+  static constexpr int SKIP_FRAMES = 2;
+  static constexpr size_t MAX_SAMPLES = 32768;
+
+  struct Sample {
+    int depth;
+    void *frames[MAX_DEPTH];
+  };
+
+  static inline std::vector<Sample> samples;
+  static inline std::atomic<size_t> taken{0};
+
+  static void on_signal(int) {
+    int saved_errno = errno;
+    size_t i = taken.fetch_add(1, std::memory_order_relaxed);
+    if (i < samples.size()) {
+      samples[i].depth = backtrace(samples[i].frames, MAX_DEPTH);
+    }
+    errno = saved_errno;
+  }
+
+  // "ns::f(int, std::string const&) const" -> "ns::f"
+  static std::string strip_params(const std::string &name) {
+    size_t end = name.rfind(')');
+    if (end == std::string::npos) {
+      return name;
+    }
+    int depth = 0;
+    for (size_t i = end + 1; i-- > 0;) {
+      if (name[i] == ')') {
+        depth++;
+      } else if (name[i] == '(' && --depth == 0) {
+        return i > 0 ? name.substr(0, i) : name;
+      }
+    }
+    return name;
+  }
+
+  struct ExeSymbol {
+    uintptr_t start;
+    uintptr_t end;
+    std::string name;
+  };
+
+  struct ExeSymbols {
+    uintptr_t base = 0;
+    uintptr_t bias = 0;
+    std::vector<ExeSymbol> functions;
+  };
+
+  // Function symbols from the executable's own .symtab. dladdr() only sees
+  // the dynamic symbol table, which lacks everything in main.cpp unless the
+  // binary was linked with -rdynamic (and static functions even then).
+  static ExeSymbols load_exe_symbols() {
+    ExeSymbols exe;
+#if defined(__linux__)
+    // The first object dl_iterate_phdr reports is the executable.
+    dl_iterate_phdr(
+        [](dl_phdr_info *info, size_t, void *data) {
+          auto *exe = static_cast<ExeSymbols *>(data);
+          exe->bias = info->dlpi_addr;
+          uintptr_t lowest = UINTPTR_MAX;
+          for (int i = 0; i < info->dlpi_phnum; i++) {
+            if (info->dlpi_phdr[i].p_type == PT_LOAD) {
+              lowest = std::min<uintptr_t>(lowest, info->dlpi_phdr[i].p_vaddr);
+            }
+          }
+          exe->base = info->dlpi_addr + (lowest & ~uintptr_t{0xfff});
+          return 1;
+        },
+        &exe);
+
+    std::ifstream file("/proc/self/exe", std::ios::binary);
+    std::string data((std::istreambuf_iterator<char>(file)),
+                     std::istreambuf_iterator<char>());
+    Elf64_Ehdr header;
+    if (data.size() < sizeof(header) ||
+        std::memcmp(data.data(), ELFMAG, SELFMAG) != 0 ||
+        data[EI_CLASS] != ELFCLASS64) {
+      return exe;
+    }
+    std::memcpy(&header, data.data(), sizeof(header));
+    if (header.e_shentsize != sizeof(Elf64_Shdr) ||
+        header.e_shoff + header.e_shnum * sizeof(Elf64_Shdr) > data.size()) {
+      return exe;
+    }
+    std::vector<Elf64_Shdr> sections(header.e_shnum);
+    std::memcpy(sections.data(), data.data() + header.e_shoff,
+                sections.size() * sizeof(Elf64_Shdr));
+
+    for (const auto &section : sections) {
+      if (section.sh_type != SHT_SYMTAB || section.sh_link >= sections.size()) {
+        continue;
+      }
+      const Elf64_Shdr &strings = sections[section.sh_link];
+      if (section.sh_offset + section.sh_size > data.size() ||
+          strings.sh_offset + strings.sh_size > data.size()) {
+        continue;
+      }
+      size_t count = section.sh_size / sizeof(Elf64_Sym);
+      for (size_t i = 0; i < count; i++) {
+        Elf64_Sym sym;
+        std::memcpy(&sym, data.data() + section.sh_offset + i * sizeof(sym),
+                    sizeof(sym));
+        if (ELF64_ST_TYPE(sym.st_info) != STT_FUNC || sym.st_value == 0 ||
+            sym.st_name >= strings.sh_size) {
+          continue;
+        }
+        const char *name = data.data() + strings.sh_offset + sym.st_name;
+        size_t len = strnlen(name, strings.sh_size - sym.st_name);
+        // A call to a noreturn function can end a function, so its return
+        // address lands in the alignment padding after it.
+        uint64_t end = (sym.st_value + std::max<uint64_t>(sym.st_size, 1) +
+                        15) &
+                       ~uint64_t{15};
+        exe.functions.push_back({sym.st_value, end, std::string(name, len)});
+      }
+    }
+    std::sort(exe.functions.begin(), exe.functions.end(),
+              [](const ExeSymbol &a, const ExeSymbol &b) {
+                return a.start < b.start;
+              });
+#endif
+    return exe;
+  }
+
+  static const char *exe_symbol(void *pc, void *fbase) {
+    static const ExeSymbols exe = load_exe_symbols();
+    if (reinterpret_cast<uintptr_t>(fbase) != exe.base) {
+      return nullptr;
+    }
+    uintptr_t addr = reinterpret_cast<uintptr_t>(pc) - exe.bias;
+    auto it = std::upper_bound(
+        exe.functions.begin(), exe.functions.end(), addr,
+        [](uintptr_t a, const ExeSymbol &sym) { return a < sym.start; });
+    if (it == exe.functions.begin() || addr >= std::prev(it)->end) {
+      return nullptr;
+    }
+    return std::prev(it)->name.c_str();
+  }
+
+  static std::string symbol(void *addr) {
+    // Return addresses point after the call; look up the call itself.
+    void *pc = static_cast<char *>(addr) - 1;
+    Dl_info info{};
+    bool found = dladdr(pc, &info) != 0;
+    const char *mangled = found ? info.dli_sname : nullptr;
+    if (found && mangled == nullptr) {
+      mangled = exe_symbol(pc, info.dli_fbase);
+    }
+    if (mangled != nullptr) {
+      int status = 0;
+      char *demangled =
+          abi::__cxa_demangle(mangled, nullptr, nullptr, &status);
+      std::string name = status == 0 ? demangled : mangled;
+      std::free(demangled);
+      return strip_params(name);
+    }
+
+    std::ostringstream oss;
+    if (info.dli_fname != nullptr) {
+      oss << fs::path(info.dli_fname).filename().string() << "+0x" << std::hex
+          << (static_cast<char *>(pc) - static_cast<char *>(info.dli_fbase));
+    } else {
+      oss << addr;
+    }
+    return oss.str();
+  }
+
+public:
+  static void start() {
+    if (samples.empty()) {
+      samples.resize(MAX_SAMPLES);
+      // The first backtrace() call loads the unwinder; do it outside the
+      // signal handler.
+      void *warm[1];
+      backtrace(warm, 1);
+    }
+    taken.store(0);
+
+    struct sigaction sa {};
+    sa.sa_handler = on_signal;
+    sa.sa_flags = SA_RESTART;
+    sigemptyset(&sa.sa_mask);
+    sigaction(SIGPROF, &sa, nullptr);
+
+    itimerval timer{};
+    timer.it_interval.tv_usec = 1'000'000 / HZ;
+    timer.it_value = timer.it_interval;
+    setitimer(ITIMER_PROF, &timer, nullptr);
+  }
+
+  static void stop() {
+    itimerval timer{};
+    setitimer(ITIMER_PROF, &timer, nullptr);
+    signal(SIGPROF, SIG_IGN);
+  }
+
+  static size_t sample_count() { return std::min(taken.load(), MAX_SAMPLES); }
+  static size_t dropped() { return taken.load() - sample_count(); }
+
+  // Writes "root;caller;callee count" lines, one per distinct stack.
+  static bool write_folded(const std::string &path) {
+    std::unordered_map<void *, std::string> names;
+    std::map<std::string, int64_t> stacks;
+    for (size_t i = 0; i < sample_count(); i++) {
+      const Sample &sample = samples[i];
+      std::string stack;
+      for (int f = sample.depth - 1; f >= SKIP_FRAMES; f--) {
+        auto it = names.find(sample.frames[f]);
+        if (it == names.end()) {
+          it = names.emplace(sample.frames[f], symbol(sample.frames[f])).first;
+        }
+        if (!stack.empty()) {
+          stack += ';';
+        }
+        stack += it->second;
+      }
+      if (!stack.empty()) {
+        stacks[stack]++;
+      }
+    }
+
+    std::ofstream out(path, std::ios::trunc);
+    if (!out.is_open()) {
+      return false;
+    }
+    for (const auto &[stack, count] : stacks) {
+      out << stack << " " << count << "\n";
+    }
+    return true;
+  }
+};
+
+// Chrome/Perfetto trace-event recorder for --trace. Spans are buffered in
+// memory and appended to the file as complete ("X") events after every
+// benchmark, so forked children add their own spans and a crash keeps what
+// was flushed (the format allows the closing bracket to be missing).
+class Tracer {
+private:
+  struct Event {
+    std::string name;
+    const char *category;
+    int64_t start_ns;
+    int64_t end_ns;
+    int tid;
+  };
+
+  static inline std::atomic<bool> enabled{false};
+  static inline std::atomic<int> next_tid{0};
+  static inline std::mutex mutex;
+  // Timed iterations only keep their number; names are built in flush(),
+  // outside the measured window.
+  struct Iteration {
+    int64_t id;
+    int64_t start_ns;
+    int64_t end_ns;
+    int tid;
+  };
+
+  static inline std::vector<Event> events;
+  static inline std::vector<Iteration> iterations;
+  static inline std::ofstream out;
+  static inline int64_t origin_ns = 0;
 
-void load_config(const std::string &filename = "../test.js") {
-  std::ifstream file(filename);
-  if (!file.is_open()) {
-    std::cerr << "Cannot open config file: " << filename << std::endl;
-    return;
+  static int thread_id() {
+    thread_local int tid = next_tid.fetch_add(1);
+    return tid;
+  }
+
+public:
+  static bool open(const std::string &path) {
+    out.open(path, std::ios::trunc);
+    if (!out.is_open()) {
+      std::cerr << "Cannot open trace file: " << path << std::endl;
+      return false;
+    }
+    out << "[" << std::endl;
+    origin_ns = Helper::now_ns();
+    enabled.store(true);
+    return true;
   }
 
-  try {
-    auto json_array = json::array();
-    file >> json_array;
+  static bool is_enabled() { return enabled.load(std::memory_order_relaxed); }
 
-    CONFIG = json::object();
-    for (const auto &item : json_array) {
-      std::string name = item["name"];
-      CONFIG[name] = item;
+  static void record(std::string name, const char *category, int64_t start_ns,
+                     int64_t end_ns) {
+    if (!is_enabled()) {
+      return;
     }
-  } catch (const std::exception &e) {
-    std::cerr << "Error parsing JSON config: " << e.what() << std::endl;
-    CONFIG = json::object();
+    int tid = thread_id();
+    std::lock_guard<std::mutex> lock(mutex);
+    events.push_back({std::move(name), category, start_ns, end_ns, tid});
   }
-}
 
-class Helper {
+  // Sizes the iteration buffer ahead of a timed loop so that
+  // record_iteration() neither allocates nor formats.
+  static void reserve_iterations(size_t count) {
+    if (is_enabled()) {
+      std::lock_guard<std::mutex> lock(mutex);
+      iterations.reserve(iterations.size() + count);
+    }
+  }
+
+  // Only called from the thread running the benchmark loop.
+  static void record_iteration(int64_t id, int64_t start_ns, int64_t end_ns) {
+    if (is_enabled()) {
+      iterations.push_back({id, start_ns, end_ns, thread_id()});
+    }
+  }
+
+  static void flush() {
+    if (!is_enabled()) {
+      return;
+    }
+    std::lock_guard<std::mutex> lock(mutex);
+    int pid = static_cast<int>(getpid());
+    // One write per flush keeps concurrent --jobs children from interleaving
+    // partial lines.
+    std::string chunk;
+    for (const auto &e : events) {
+      json ev = {{"name", e.name},
+                 {"cat", e.category},
+                 {"ph", "X"},
+                 {"ts", (e.start_ns - origin_ns) / 1e3},
+                 {"dur", (e.end_ns - e.start_ns) / 1e3},
+                 {"pid", pid},
+                 {"tid", e.tid}};
+      chunk += ev.dump() + ",\n";
+    }
+    for (const auto &it : iterations) {
+      json ev = {{"name", "iteration " + std::to_string(it.id)},
+                 {"cat", "run"},
+                 {"ph", "X"},
+                 {"ts", (it.start_ns - origin_ns) / 1e3},
+                 {"dur", (it.end_ns - it.start_ns) / 1e3},
+                 {"pid", pid},
+                 {"tid", it.tid}};
+      chunk += ev.dump() + ",\n";
+    }
+    out << chunk << std::flush;
+    events.clear();
+    iterations.clear();
+  }
+};
+
+class TraceSpan {
 private:
-  static const int64_t IM = 139968;
-  static const int64_t IA = 3877;
-  static const int64_t IC = 29573;
+  std::string name;
+  const char *category;
+  int64_t start_ns = 0;
 
-  static thread_local int64_t last;
+public:
+  TraceSpan(std::string name, const char *category)
+      : name(std::move(name)), category(category) {
+    if (Tracer::is_enabled()) {
+      start_ns = Helper::now_ns();
+    }
+  }
+
+  TraceSpan(const TraceSpan &) = delete;
+  TraceSpan &operator=(const TraceSpan &) = delete;
+
+  ~TraceSpan() {
+    if (Tracer::is_enabled()) {
+      Tracer::record(std::move(name), category, start_ns, Helper::now_ns());
+    }
+  }
+};
 
+// On-disk cache of prepared benchmark inputs. Each entry is one file named
+// after the benchmark and a hash of its config section and of the binary
+// that wrote it, so a rebuilt prepare() never picks up old data. A file
+// holds a fixed header followed by a payload the benchmark serializes
+// itself. Entries are mapped read-only and validated (magic, version, key,
+// size and an FNV-1a checksum of the payload) before use, so a torn file is
+// treated as a miss and rebuilt. A resident process (--serve) additionally
+// keeps entries in memory.
+class PrepCache {
 public:
-  static void reset() { last = 42; }
+  class Writer {
+  public:
+    template <typename T> void write(const T &value) {
+      static_assert(std::is_trivially_copyable_v<T>);
+      buf.append(reinterpret_cast<const char *>(&value), sizeof(T));
+    }
 
-  static int32_t next_int(int32_t max) {
-    last = (last * IA + IC) % IM;
-    return static_cast<int32_t>((last * max) / IM);
+    template <typename T> void write(const std::vector<T> &values) {
+      static_assert(std::is_trivially_copyable_v<T>);
+      write<uint64_t>(values.size());
+      buf.append(reinterpret_cast<const char *>(values.data()),
+                 values.size() * sizeof(T));
+    }
+
+    void write(const std::string &value) {
+      write<uint64_t>(value.size());
+      buf.append(value);
+    }
+
+    std::string buf;
+  };
+
+  class Reader {
+  private:
+    const char *pos;
+    const char *end;
+
+  public:
+    Reader(const char *data, size_t size) : pos(data), end(data + size) {}
+
+    template <typename T> bool read(T &value) {
+      static_assert(std::is_trivially_copyable_v<T>);
+      if (static_cast<size_t>(end - pos) < sizeof(T)) {
+        return false;
+      }
+      std::memcpy(&value, pos, sizeof(T));
+      pos += sizeof(T);
+      return true;
+    }
+
+    template <typename T> bool read(std::vector<T> &values) {
+      static_assert(std::is_trivially_copyable_v<T>);
+      uint64_t n = 0;
+      if (!read(n) || n > static_cast<size_t>(end - pos) / sizeof(T)) {
+        return false;
+      }
+      values.resize(static_cast<size_t>(n));
+      std::memcpy(values.data(), pos, n * sizeof(T));
+      pos += n * sizeof(T);
+      return true;
+    }
+
+    bool read(std::string &value) {
+      uint64_t n = 0;
+      if (!read(n) || n > static_cast<size_t>(end - pos)) {
+        return false;
+      }
+      value.assign(pos, static_cast<size_t>(n));
+      pos += n;
+      return true;
+    }
+
+    bool done() const { return pos == end; }
+  };
+
+  enum Status { UNCACHED, HIT, STORED };
+
+private:
+  static constexpr char MAGIC[8] = {'B', 'E', 'N', 'C', 'H', 'P', 'R', 'E'};
+  static constexpr uint32_t VERSION = 1;
+
+  struct Header {
+    char magic[8];
+    uint32_t version;
+    uint32_t reserved;
+    uint64_t key;
+    uint64_t payload_size;
+    uint64_t payload_checksum;
+    int64_t helper_state;
+  };
+
+  struct Entry {
+    std::string payload;
+    int64_t helper_state;
+  };
+
+  static inline std::string dir;
+  static inline bool resident = false;
+  static inline std::unordered_map<std::string, Entry> memory;
+
+  static uint64_t fnv1a(const char *data, size_t size,
+                        uint64_t hash = 14695981039346656037ULL) {
+    for (size_t i = 0; i < size; i++) {
+      hash ^= static_cast<uint8_t>(data[i]);
+      hash *= 1099511628211ULL;
+    }
+    return hash;
   }
 
-  static int32_t next_int(int32_t from, int32_t to) {
-    return next_int(to - from + 1) + from;
+  static std::string entry_name(const std::string &name, uint64_t key) {
+    std::string file;
+    for (char c : name) {
+      file += std::isalnum(static_cast<unsigned char>(c)) ? c : '_';
+    }
+    std::ostringstream hex;
+    hex << std::hex << std::setw(16) << std::setfill('0') << key;
+    return file + "-" + hex.str();
   }
 
-  static double next_float(double max = 1.0) {
-    last = (last * IA + IC) % IM;
-    return max * static_cast<double>(last) / IM;
+  static std::string path(const std::string &name, uint64_t key) {
+    return (fs::path(dir) / (entry_name(name, key) + ".bin")).string();
   }
 
-  static uint32_t checksum(const std::string &v) {
-    uint32_t hash = 5381;
-    for (char c : v) {
-      hash = ((hash << 5) + hash) + static_cast<uint8_t>(c);
+public:
+  static bool open(const std::string &directory) {
+    std::error_code ec;
+    fs::create_directories(directory, ec);
+    if (ec) {
+      std::cerr << "Cannot create cache directory: " << directory << " ("
+                << ec.message() << ")" << std::endl;
+      return false;
+    }
+    dir = directory;
+    return true;
+  }
+
+  static void keep_in_memory() { resident = true; }
+
+  static bool is_enabled() { return resident || !dir.empty(); }
+
+  // Hash of the running executable, read once; elsewhere the compile time
+  // stands in for it. Either way the build flags are mixed in.
+  static uint64_t build_id() {
+    static const uint64_t id = []() {
+#if defined(__linux__)
+      std::ifstream exe("/proc/self/exe", std::ios::binary);
+      std::string data((std::istreambuf_iterator<char>(exe)),
+                       std::istreambuf_iterator<char>());
+#else
+      std::string data = __DATE__ " " __TIME__;
+#endif
+#ifdef BUILD_FLAGS
+      data += BUILD_FLAGS;
+#endif
+      return fnv1a(data.data(), data.size());
+    }();
+    return id;
+  }
+
+  // Hash of the benchmark's config section and build_id().
+  static uint64_t key(const std::string &name) {
+    std::string config = Config::to_json(name).dump();
+    config += "|" + std::to_string(build_id());
+    return fnv1a(config.data(), config.size());
+  }
+
+  // Maps the entry for `name` and hands the payload to `read_payload`. On
+  // success the generator is restored to its post-prepare state.
+  static bool load(const std::string &name, uint64_t key,
+                   const std::function<bool(Reader &)> &read_payload) {
+    if (resident) {
+      auto it = memory.find(entry_name(name, key));
+      if (it != memory.end()) {
+        const Entry &entry = it->second;
+        Reader in(entry.payload.data(), entry.payload.size());
+        if (read_payload(in) && in.done()) {
+          Helper::set_state(entry.helper_state);
+          return true;
+        }
+      }
     }
-    return hash;
+    if (dir.empty()) {
+      return false;
+    }
+
+    int fd = ::open(path(name, key).c_str(), O_RDONLY);
+    if (fd < 0) {
+      return false;
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0 ||
+        static_cast<size_t>(st.st_size) < sizeof(Header)) {
+      close(fd);
+      return false;
+    }
+    size_t size = static_cast<size_t>(st.st_size);
+    void *map = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED) {
+      return false;
+    }
+
+    const char *base = static_cast<const char *>(map);
+    Header header;
+    std::memcpy(&header, base, sizeof(Header));
+    const char *payload = base + sizeof(Header);
+    bool ok = std::memcmp(header.magic, MAGIC, sizeof(MAGIC)) == 0 &&
+              header.version == VERSION && header.key == key &&
+              header.payload_size == size - sizeof(Header) &&
+              header.payload_checksum ==
+                  fnv1a(payload, static_cast<size_t>(header.payload_size));
+    if (ok) {
+      Reader in(payload, static_cast<size_t>(header.payload_size));
+      ok = read_payload(in) && in.done();
+    }
+    munmap(map, size);
+
+    if (ok) {
+      Helper::set_state(header.helper_state);
+      if (resident) {
+        memory[entry_name(name, key)] = {
+            std::string(payload, static_cast<size_t>(header.payload_size)),
+            header.helper_state};
+      }
+    }
+    return ok;
   }
 
-  static uint32_t checksum(const std::vector<uint8_t> &v) {
-    uint32_t hash = 5381;
-    for (uint8_t byte : v) {
-      hash = ((hash << 5) + hash) + byte;
+  // Serializes the prepared input of `name` together with the current
+  // (post-prepare) generator state. Written to a temporary file and renamed,
+  // so concurrent runs never observe a partial entry.
+  static bool store(const std::string &name, uint64_t key,
+                    const std::function<bool(Writer &)> &write_payload) {
+    Writer out;
+    if (!write_payload(out)) {
+      return false;
     }
-    return hash;
+    if (resident) {
+      memory[entry_name(name, key)] = {out.buf, Helper::state()};
+    }
+    if (dir.empty()) {
+      return true;
+    }
+
+    Header header;
+    std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+    header.version = VERSION;
+    header.reserved = 0;
+    header.key = key;
+    header.payload_size = out.buf.size();
+    header.payload_checksum = fnv1a(out.buf.data(), out.buf.size());
+    header.helper_state = Helper::state();
+
+    std::string target = path(name, key);
+    std::string tmp = target + ".tmp" + std::to_string(getpid());
+    std::ofstream file(tmp, std::ios::binary | std::ios::trunc);
+    file.write(reinterpret_cast<const char *>(&header), sizeof(Header));
+    file.write(out.buf.data(), static_cast<std::streamsize>(out.buf.size()));
+    file.close();
+
+    std::error_code ec;
+    if (file) {
+      fs::rename(tmp, target, ec);
+    }
+    if (!file || ec) {
+      fs::remove(tmp, ec);
+      return false;
+    }
+    return true;
   }
+};
 
-  static uint32_t checksum_f64(double v) {
-    std::ostringstream oss;
-    oss << std::fixed << std::setprecision(7) << v;
-    return Helper::checksum(oss.str());
+// Runtime CPU-feature dispatch. The binary is built for the baseline ISA;
+// hot kernels (namespace Simd) are additionally compiled for wider vector
+// units with target attributes, and callers pick the variant for the level
+// detected here once per process, or the one forced with --isa=.
+class Isa {
+public:
+  enum Level { SCALAR, SSE42, AVX2, AVX512, LEVELS };
+
+private:
+  static inline Level current = LEVELS;
+
+public:
+  static const char *name(Level level) {
+    static const char *names[] = {"scalar", "sse4.2", "avx2", "avx512"};
+    return names[level];
   }
 
-  static int64_t config_i64(const std::string &class_name,
-                            const std::string &field_name) {
-    try {
-      if (CONFIG.contains(class_name) &&
-          CONFIG[class_name].contains(field_name)) {
-        return CONFIG[class_name][field_name].get<int64_t>();
-      } else {
-        throw std::runtime_error("Config not found for " + class_name +
-                                 ", field: " + field_name);
-      }
-    } catch (const std::exception &e) {
-      std::cerr << e.what() << std::endl;
-      return 0;
+  static Level detected() {
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512f")) {
+      return AVX512;
+    }
+    if (__builtin_cpu_supports("avx2")) {
+      return AVX2;
+    }
+    if (__builtin_cpu_supports("sse4.2")) {
+      return SSE42;
     }
+#endif
+    return SCALAR;
   }
 
-  static std::string config_s(const std::string &class_name,
-                              const std::string &field_name) {
-    try {
-      if (CONFIG.contains(class_name) &&
-          CONFIG[class_name].contains(field_name)) {
-        return CONFIG[class_name][field_name].get<std::string>();
-      } else {
-        throw std::runtime_error("Config not found for " + class_name +
-                                 ", field: " + field_name);
+  static Level active() {
+    if (current == LEVELS) {
+      current = detected();
+    }
+    return current;
+  }
+
+  // Selects a level by name; levels above what the CPU supports are
+  // rejected rather than crashing on the first illegal instruction.
+  static bool force(const std::string &level_name) {
+    for (int l = SCALAR; l < LEVELS; l++) {
+      if (level_name != name(static_cast<Level>(l))) {
+        continue;
       }
-    } catch (const std::exception &e) {
-      std::cerr << e.what() << std::endl;
-      return "";
+      if (l > detected()) {
+        std::cerr << "ISA " << level_name << " not supported by this CPU ("
+                  << name(detected()) << ")" << std::endl;
+        return false;
+      }
+      current = static_cast<Level>(l);
+      return true;
     }
+    std::cerr << "Unknown ISA: " << level_name
+              << " (expected scalar, sse4.2, avx2 or avx512)" << std::endl;
+    return false;
   }
 };
 
-thread_local int64_t Helper::last = 42;
-
 class Benchmark {
 public:
   virtual ~Benchmark() = default;
@@ -153,9 +1589,9 @@ public:
   virtual std::string name() const = 0;
 
   int64_t warmup_iterations() {
-    if (CONFIG.contains(name()) &&
-        CONFIG[name()].contains("warmup_iterations")) {
-      return CONFIG[name()]["warmup_iterations"].get<int64_t>();
+    if (auto configured = Helper::config_i64(config_section(),
+                                             ConfigKey::WARMUP_ITERATIONS)) {
+      return *configured;
     } else {
       int64_t iters = iterations();
       return std::max<int64_t>(static_cast<int64_t>(iters * 0.2), 1LL);
@@ -169,25 +1605,154 @@ public:
     }
   }
 
+  void run_timed(int64_t iteration_id) {
+    int64_t t0 = Helper::now_ns();
+    this->run(static_cast<int>(iteration_id));
+    int64_t t1 = Helper::now_ns();
+    latency.record(t1 - t0);
+    timings.push_back(t1 - t0);
+    Tracer::record_iteration(iteration_id, t0, t1);
+  }
+
   void run_all() {
     int64_t iters = iterations();
     for (int64_t i = 0; i < iters; i++) {
-      this->run(i);
+      run_timed(i);
+    }
+  }
+
+  // Adaptive warmup: runs windows of STEADY_WINDOW iterations until two
+  // consecutive window means differ by less than STEADY_TOLERANCE (no more
+  // level shift, i.e. JIT/cache/frequency settling is over) or the deadline
+  // passes. Returns the number of warmup iterations and whether it settled.
+  std::pair<int64_t, bool> warmup_adaptive(int64_t deadline_ns) {
+    static constexpr int STEADY_WINDOW = 5;
+    static constexpr double STEADY_TOLERANCE = 0.05;
+
+    int64_t iters = 0;
+    double prev_mean = -1.0;
+    int steady_windows = 0;
+    while (Helper::now_ns() < deadline_ns) {
+      int64_t t0 = Helper::now_ns();
+      for (int i = 0; i < STEADY_WINDOW; i++) {
+        this->run(static_cast<int>(iters++));
+      }
+      double mean = static_cast<double>(Helper::now_ns() - t0) / STEADY_WINDOW;
+      if (prev_mean > 0.0 &&
+          std::abs(mean - prev_mean) / prev_mean < STEADY_TOLERANCE) {
+        if (++steady_windows == 2) {
+          return {iters, true};
+        }
+      } else {
+        steady_windows = 0;
+      }
+      prev_mean = mean;
+    }
+    return {iters, false};
+  }
+
+  // Samples timed iterations until the 95% confidence interval of the mean
+  // is within target_ci of the mean or the deadline passes. Returns whether
+  // the target was reached.
+  bool run_adaptive(double target_ci, int64_t deadline_ns) {
+    static constexpr int64_t MIN_SAMPLES = 10;
+
+    for (int64_t i = 0;; i++) {
+      run_timed(i);
+      if (latency.count() >= MIN_SAMPLES) {
+        double n = static_cast<double>(latency.count());
+        double half_width =
+            t_quantile_95(n - 1.0) * latency.stddev() / std::sqrt(n);
+        if (half_width <= target_ci * latency.mean()) {
+          return true;
+        }
+      }
+      if (Helper::now_ns() >= deadline_ns) {
+        return false;
+      }
+    }
+  }
+
+  LatencyHistogram latency;
+  std::vector<int64_t> timings;
+
+  virtual int threads() const { return 1; }
+  virtual bool parallel() const { return false; }
+
+  // Work done by one run() (digits, nodes, ...) and its unit, for per-unit
+  // figures such as --alloc's allocs/<unit>; 0 when there is no such unit.
+  virtual int64_t units_per_iteration() const { return 0; }
+  virtual const char *unit_name() const { return "item"; }
+
+  // Benchmarks whose prepare() is expensive serialize the prepared input for
+  // PrepCache; load_prepared() must leave the instance as prepare() would.
+  virtual bool save_prepared(PrepCache::Writer &) const { return false; }
+  virtual bool load_prepared(PrepCache::Reader &) { return false; }
+
+  // Index of this benchmark's config section, looked up by name once.
+  int config_section() const {
+    if (section_id == UNRESOLVED) {
+      section_id = Config::section_id(name());
+    }
+    return section_id;
+  }
+
+  // Config field by interned id (ConfigKey); 0 and a warning if missing.
+  int64_t config_val(int key) const {
+    if (auto value = Helper::config_i64(config_section(), key)) {
+      return *value;
     }
+    std::cerr << "Config not found for " << name()
+              << ", field: " << Config::key_name(key) << std::endl;
+    return 0;
   }
 
-  int64_t config_val(const std::string &field_name) const {
-    return Helper::config_i64(this->name(), field_name);
+  std::string config_str(int key) const {
+    if (auto value = Helper::config_s(config_section(), key)) {
+      return *value;
+    }
+    std::cerr << "Config not found for " << name()
+              << ", field: " << Config::key_name(key) << std::endl;
+    return "";
   }
 
-  int64_t iterations() const { return config_val("iterations"); }
+  int64_t iterations() const { return config_val(ConfigKey::ITERATIONS); }
+
+  int64_t expected_checksum() const {
+    return config_val(ConfigKey::CHECKSUM);
+  }
 
-  int64_t expected_checksum() const { return config_val("checksum"); }
+  static void all(const std::string &single_bench = "");
 
-  static void all(const std::string &single_bench = "",
-                  const std::string &config_file = "../test.js");
+private:
+  static constexpr int UNRESOLVED = -2;
+  mutable int section_id = UNRESOLVED;
 };
 
+using BenchFactory = std::function<std::unique_ptr<Benchmark>()>;
+
+// prepare(), going through PrepCache when --cache is set.
+PrepCache::Status prepare_cached(Benchmark &bench) {
+  if (!PrepCache::is_enabled()) {
+    bench.prepare();
+    return PrepCache::UNCACHED;
+  }
+
+  std::string name = bench.name();
+  uint64_t key = PrepCache::key(name);
+  if (PrepCache::load(name, key, [&](PrepCache::Reader &in) {
+        return bench.load_prepared(in);
+      })) {
+    return PrepCache::HIT;
+  }
+
+  bench.prepare();
+  bool stored = PrepCache::store(name, key, [&](PrepCache::Writer &out) {
+    return bench.save_prepared(out);
+  });
+  return stored ? PrepCache::STORED : PrepCache::UNCACHED;
+}
+
 double custom_round(double value, int32_t precision) {
   if (std::isnan(value) || std::isinf(value)) {
     return value;
@@ -214,13 +1779,16 @@ private:
   std::ostringstream result_stream;
 
 public:
-  Pidigits() : nn(static_cast<int32_t>(config_val("amount"))) {
+  Pidigits() : nn(static_cast<int32_t>(config_val(ConfigKey::AMOUNT))) {
     result_stream.str("");
     result_stream.clear();
   }
 
   std::string name() const override { return "CLBG::Pidigits"; }
 
+  int64_t units_per_iteration() const override { return nn; }
+  const char *unit_name() const override { return "digit"; }
+
   void run(int iteration_id) override {
     int i = 0;
     int k = 0;
@@ -234,36 +1802,235 @@ public:
 
     while (true) {
       k += 1;
-      t = n * 2;
-      n *= k;
+      t = n * 2;
+      n *= k;
+      k1 += 2;
+      a = (a + t) * k1;
+      d *= k1;
+
+      if (a >= n) {
+        mpz_class temp = n * 3 + a;
+        mpz_class q = temp / d;
+        u = temp % d;
+        u += n;
+
+        if (d > u) {
+          ns = ns * 10 + q;
+          i += 1;
+
+          if (i % 10 == 0) {
+            std::string ns_str = ns.get_str();
+            if (ns_str.size() < 10) {
+              ns_str = std::string(10 - ns_str.size(), '0') + ns_str;
+            }
+            result_stream << ns_str << "\t:" << i << "\n";
+            ns = 0;
+          }
+
+          if (i >= nn)
+            break;
+
+          a = (a - (d * q)) * 10;
+          n *= 10;
+        }
+      }
+    }
+  }
+
+  uint32_t checksum() override { return Helper::checksum(result_stream.str()); }
+};
+
+// Same digits as Pidigits, computed in one block with the Chudnovsky series
+//   1/pi = 12 / 640320^(3/2) * sum_k (-1)^k (6k)! (13591409 + 545140134 k)
+//                                     / ((3k)! (k!)^3 640320^(3k))
+// evaluated by binary splitting, so the cost is a few big multiplications
+// instead of a quadratic number of small steps. Each term adds ~14.18
+// digits. With threads() > 1 the top levels of the recursion run on
+// separate threads.
+class PidigitsBinarySplit : public Benchmark {
+private:
+  static constexpr double DIGITS_PER_TERM = 14.181647462725477;
+  static constexpr int GUARD_DIGITS = 16;
+  static constexpr int64_t PARALLEL_MIN_TERMS = 256;
+
+  struct PQT {
+    mpz_class p, q, t;
+  };
+
+  int32_t nn;
+  std::ostringstream result_stream;
+
+  // P, Q, T of the terms [a, b).
+  static PQT split(int64_t a, int64_t b, int depth) {
+    // 640320^3 / 24
+    static const mpz_class C3_OVER_24("10939058860032000");
+
+    PQT r;
+    if (b - a == 1) {
+      long k = static_cast<long>(a);
+      if (k == 0) {
+        r.p = r.q = 1;
+      } else {
+        r.p = 6 * k - 5;
+        r.p *= 2 * k - 1;
+        r.p *= 6 * k - 1;
+        r.p = -r.p;
+        r.q = k;
+        r.q *= k;
+        r.q *= k;
+        r.q *= C3_OVER_24;
+      }
+      r.t = r.p * (13591409 + 545140134 * mpz_class(k));
+      return r;
+    }
+
+    int64_t m = (a + b) / 2;
+    PQT left, right;
+    if (depth > 0 && b - a >= PARALLEL_MIN_TERMS) {
+      std::thread worker([&]() { left = split(a, m, depth - 1); });
+      right = split(m, b, depth - 1);
+      worker.join();
+    } else {
+      left = split(a, m, 0);
+      right = split(m, b, 0);
+    }
+
+    r.t = left.t * right.q + left.p * right.t;
+    r.p = left.p * right.p;
+    r.q = left.q * right.q;
+    return r;
+  }
+
+  // First `digits` digits of pi ("31415..."), computed with guard digits
+  // so truncation never reaches the digits returned.
+  std::string pi_digits(int64_t digits) const {
+    int64_t precision = digits + GUARD_DIGITS;
+    int64_t terms =
+        static_cast<int64_t>(static_cast<double>(precision) / DIGITS_PER_TERM) +
+        2;
+    int depth = 0;
+    while ((1 << depth) < threads()) {
+      depth++;
+    }
+    PQT s = split(0, terms, depth);
+
+    // pi = 426880 * sqrt(10005) * Q / T, scaled by 10^precision.
+    mpz_class scale;
+    mpz_ui_pow_ui(scale.get_mpz_t(), 10, static_cast<unsigned long>(precision));
+    mpz_class root = 10005 * scale * scale;
+    mpz_sqrt(root.get_mpz_t(), root.get_mpz_t());
+    mpz_class pi = 426880 * root * s.q / s.t;
+
+    return pi.get_str().substr(0, static_cast<size_t>(digits));
+  }
+
+public:
+  PidigitsBinarySplit()
+      : nn(static_cast<int32_t>(config_val(ConfigKey::AMOUNT))) {}
+
+  std::string name() const override { return "CLBG::PidigitsBinarySplit"; }
+
+  int64_t units_per_iteration() const override { return nn; }
+  const char *unit_name() const override { return "digit"; }
+
+  int threads() const override {
+    return OPTIONS.threads > 0 ? OPTIONS.threads : 1;
+  }
+
+  bool parallel() const override { return threads() > 1; }
+
+  void run(int iteration_id) override {
+    // Like the spigot, only complete groups of ten digits are printed.
+    int64_t groups = nn / 10;
+    std::string digits = pi_digits(groups * 10);
+    for (int64_t g = 0; g < groups; g++) {
+      result_stream << std::string_view(digits).substr(g * 10, 10) << "\t:"
+                    << (g + 1) * 10 << "\n";
+    }
+  }
+
+  uint32_t checksum() override { return Helper::checksum(result_stream.str()); }
+};
+
+// The Pidigits spigot on a fixed set of mpz_t registers: every step is an
+// in-place mpz_*_ui call, and the registers are sized up front with
+// mpz_realloc2 for the largest value the target digit count reaches, so the
+// loop itself does not grow limbs the way mpz_class temporaries do.
+class PidigitsInPlace : public Benchmark {
+private:
+  int32_t nn;
+  std::ostringstream result_stream;
+  mpz_t n, a, d, t, u, q;
+
+  // Upper bound on the bits of the spigot's registers for `digits` digits.
+  // The loop takes ~log2(10) steps per digit and d = 3 * 5 * ... * (2k+1),
+  // which is the largest of them; n and a stay within a few bits of it.
+  static mp_bitcnt_t register_bits(int64_t digits) {
+    double k = std::ceil(static_cast<double>(digits) * std::log2(10.0)) + 16;
+    double ln_d =
+        std::lgamma(2 * k + 2) - k * std::log(2.0) - std::lgamma(k + 1);
+    return static_cast<mp_bitcnt_t>(ln_d / std::log(2.0)) + 64;
+  }
+
+public:
+  PidigitsInPlace() : nn(static_cast<int32_t>(config_val(ConfigKey::AMOUNT))) {
+    mpz_inits(n, a, d, t, u, q, nullptr);
+    mp_bitcnt_t bits = register_bits(nn);
+    for (mpz_ptr r : {n, a, d, t, u}) {
+      mpz_realloc2(r, bits);
+    }
+  }
+
+  ~PidigitsInPlace() override { mpz_clears(n, a, d, t, u, q, nullptr); }
+
+  std::string name() const override { return "CLBG::PidigitsInPlace"; }
+
+  int64_t units_per_iteration() const override { return nn; }
+  const char *unit_name() const override { return "digit"; }
+
+  void run(int iteration_id) override {
+    int i = 0;
+    unsigned long k = 0;
+    unsigned long k1 = 1;
+    uint64_t ns = 0;
+    mpz_set_ui(a, 0);
+    mpz_set_ui(n, 1);
+    mpz_set_ui(d, 1);
+
+    while (true) {
+      k += 1;
+      mpz_mul_2exp(t, n, 1);
+      mpz_mul_ui(n, n, k);
       k1 += 2;
-      a = (a + t) * k1;
-      d *= k1;
-
-      if (a >= n) {
-        mpz_class temp = n * 3 + a;
-        mpz_class q = temp / d;
-        u = temp % d;
-        u += n;
-
-        if (d > u) {
-          ns = ns * 10 + q;
+      mpz_add(a, a, t);
+      mpz_mul_ui(a, a, k1);
+      mpz_mul_ui(d, d, k1);
+
+      if (mpz_cmp(a, n) >= 0) {
+        mpz_mul_ui(t, n, 3);
+        mpz_add(t, t, a);
+        mpz_tdiv_qr(q, u, t, d);
+        mpz_add(u, u, n);
+
+        if (mpz_cmp(d, u) > 0) {
+          unsigned long digit = mpz_get_ui(q);
+          ns = ns * 10 + digit;
           i += 1;
 
           if (i % 10 == 0) {
-            std::string ns_str = ns.get_str();
-            if (ns_str.size() < 10) {
-              ns_str = std::string(10 - ns_str.size(), '0') + ns_str;
-            }
-            result_stream << ns_str << "\t:" << i << "\n";
+            char buf[24];
+            snprintf(buf, sizeof(buf), "%010llu",
+                     static_cast<unsigned long long>(ns));
+            result_stream << buf << "\t:" << i << "\n";
             ns = 0;
           }
 
           if (i >= nn)
             break;
 
-          a = (a - (d * q)) * 10;
-          n *= 10;
+          mpz_submul_ui(a, d, digit);
+          mpz_mul_ui(a, a, 10);
+          mpz_mul_ui(n, n, 10);
         }
       }
     }
@@ -302,10 +2069,15 @@ private:
   uint32_t result_val;
 
 public:
-  BinarytreesObj() : n(config_val("depth")), result_val(0) {}
+  BinarytreesObj() : n(config_val(ConfigKey::DEPTH)), result_val(0) {}
 
   std::string name() const override { return "Binarytrees::Obj"; }
 
+  int64_t units_per_iteration() const override {
+    return (int64_t{2} << config_val(ConfigKey::DEPTH)) - 1;
+  }
+  const char *unit_name() const override { return "node"; }
+
   void run(int iteration_id) override {
     TreeNode root(0, n);
     result_val += root.sum();
@@ -358,10 +2130,15 @@ private:
   }
 
 public:
-  BinarytreesArena() : n(config_val("depth")), result_val(0) {}
+  BinarytreesArena() : n(config_val(ConfigKey::DEPTH)), result_val(0) {}
 
   std::string name() const override { return "Binarytrees::Arena"; }
 
+  int64_t units_per_iteration() const override {
+    return (int64_t{2} << config_val(ConfigKey::DEPTH)) - 1;
+  }
+  const char *unit_name() const override { return "node"; }
+
   void run(int iteration_id) override {
     arena = std::vector<TreeNode>();
     build_tree(0, static_cast<int32_t>(n));
@@ -371,6 +2148,356 @@ public:
   uint32_t checksum() override { return result_val; }
 };
 
+// Binarytrees on a work-stealing pool: above `cutoff` the right subtree is
+// pushed as a task on the worker's own deque while the worker builds the
+// left one, then joined; idle workers steal the oldest task from another
+// deque. Subtrees of depth <= cutoff are built and summed sequentially.
+// Nodes come from the building worker's bump arena, reused across
+// iterations, so workers never contend on malloc.
+class BinarytreesParallel : public Benchmark {
+private:
+  struct TreeNode {
+    TreeNode *left;
+    TreeNode *right;
+    int32_t item;
+  };
+
+  class NodeArena {
+  private:
+    static constexpr size_t BLOCK_NODES = 1 << 14;
+
+    std::vector<std::unique_ptr<TreeNode[]>> blocks;
+    TreeNode *current = nullptr;
+    size_t next_block = 0;
+    size_t used = BLOCK_NODES;
+
+  public:
+    TreeNode *alloc(int32_t item) {
+      if (used == BLOCK_NODES) {
+        if (next_block == blocks.size()) {
+          blocks.push_back(std::make_unique<TreeNode[]>(BLOCK_NODES));
+        }
+        current = blocks[next_block++].get();
+        used = 0;
+      }
+      TreeNode *node = &current[used++];
+      node->left = nullptr;
+      node->right = nullptr;
+      node->item = item;
+      return node;
+    }
+
+    // Keeps the blocks; the next iteration refills them from the start.
+    void reset() {
+      next_block = 0;
+      used = BLOCK_NODES;
+    }
+  };
+
+  struct Task {
+    int32_t item;
+    int32_t depth;
+    TreeNode *node = nullptr;
+    uint32_t sum = 0;
+    std::atomic<bool> done{false};
+  };
+
+  struct alignas(64) Worker {
+    std::mutex lock;
+    std::deque<Task *> tasks;
+    NodeArena arena;
+  };
+
+  int64_t n;
+  int32_t cutoff;
+  uint32_t result_val;
+  std::vector<std::unique_ptr<Worker>> workers;
+  std::vector<std::thread> pool;
+  std::atomic<bool> active{false};
+  std::atomic<bool> stop{false};
+  std::atomic<uint32_t> generation{0};
+
+  static TreeNode *build_seq(NodeArena &arena, int32_t item, int32_t depth) {
+    TreeNode *node = arena.alloc(item);
+    if (depth > 0) {
+      node->left = build_seq(arena, item - (1 << (depth - 1)), depth - 1);
+      node->right = build_seq(arena, item + (1 << (depth - 1)), depth - 1);
+    }
+    return node;
+  }
+
+  static uint32_t sum_seq(const TreeNode *node) {
+    uint32_t total = static_cast<uint32_t>(node->item) + 1;
+    if (node->left) {
+      total += sum_seq(node->left);
+    }
+    if (node->right) {
+      total += sum_seq(node->right);
+    }
+    return total;
+  }
+
+  Task *pop(int w) {
+    Worker &self = *workers[w];
+    std::lock_guard<std::mutex> guard(self.lock);
+    if (self.tasks.empty()) {
+      return nullptr;
+    }
+    Task *task = self.tasks.back();
+    self.tasks.pop_back();
+    return task;
+  }
+
+  Task *steal(int w) {
+    int count = static_cast<int>(workers.size());
+    for (int i = 1; i < count; i++) {
+      Worker &victim = *workers[(w + i) % count];
+      std::lock_guard<std::mutex> guard(victim.lock);
+      if (!victim.tasks.empty()) {
+        Task *task = victim.tasks.front();
+        victim.tasks.pop_front();
+        return task;
+      }
+    }
+    return nullptr;
+  }
+
+  void execute(int w, Task *task) {
+    task->node = build(w, task->item, task->depth, task->sum);
+    task->done.store(true, std::memory_order_release);
+  }
+
+  TreeNode *build(int w, int32_t item, int32_t depth, uint32_t &total) {
+    NodeArena &arena = workers[w]->arena;
+    if (depth <= cutoff) {
+      TreeNode *node = build_seq(arena, item, depth);
+      total = sum_seq(node);
+      return node;
+    }
+
+    TreeNode *node = arena.alloc(item);
+    Task right;
+    right.item = item + (1 << (depth - 1));
+    right.depth = depth - 1;
+    {
+      std::lock_guard<std::mutex> guard(workers[w]->lock);
+      workers[w]->tasks.push_back(&right);
+    }
+
+    uint32_t left_sum = 0;
+    node->left = build(w, item - (1 << (depth - 1)), depth - 1, left_sum);
+
+    // Everything pushed after `right` has been joined already, so the back
+    // of the deque is `right` unless a thief took it; then help out with
+    // other work until it is done.
+    if (Task *task = pop(w)) {
+      execute(w, task);
+    }
+    while (!right.done.load(std::memory_order_acquire)) {
+      if (Task *task = steal(w)) {
+        execute(w, task);
+      } else {
+        std::this_thread::yield();
+      }
+    }
+    node->right = right.node;
+    total = static_cast<uint32_t>(item) + 1 + left_sum + right.sum;
+    return node;
+  }
+
+  void worker_loop(int w) {
+    uint32_t seen = 0;
+    while (true) {
+      generation.wait(seen);
+      seen = generation.load();
+      if (stop.load()) {
+        return;
+      }
+      while (active.load(std::memory_order_acquire)) {
+        if (Task *task = steal(w)) {
+          execute(w, task);
+        } else {
+          std::this_thread::yield();
+        }
+      }
+    }
+  }
+
+public:
+  BinarytreesParallel()
+      : n(config_val(ConfigKey::DEPTH)),
+        cutoff(static_cast<int32_t>(config_val(ConfigKey::CUTOFF))),
+        result_val(0) {}
+
+  ~BinarytreesParallel() override {
+    stop.store(true);
+    generation.fetch_add(1);
+    generation.notify_all();
+    for (auto &thread : pool) {
+      thread.join();
+    }
+  }
+
+  std::string name() const override { return "Binarytrees::Parallel"; }
+
+  int64_t units_per_iteration() const override {
+    return (int64_t{2} << config_val(ConfigKey::DEPTH)) - 1;
+  }
+  const char *unit_name() const override { return "node"; }
+
+  int threads() const override {
+    return OPTIONS.threads > 0 ? OPTIONS.threads : 4;
+  }
+
+  bool parallel() const override { return true; }
+
+  void prepare() override {
+    int count = threads();
+    for (int w = 0; w < count; w++) {
+      workers.push_back(std::make_unique<Worker>());
+    }
+    for (int w = 1; w < count; w++) {
+      pool.emplace_back([this, w]() { worker_loop(w); });
+    }
+  }
+
+  void run(int iteration_id) override {
+    for (auto &worker : workers) {
+      worker->arena.reset();
+    }
+    active.store(true, std::memory_order_release);
+    generation.fetch_add(1);
+    generation.notify_all();
+
+    uint32_t total = 0;
+    build(0, 0, static_cast<int32_t>(n), total);
+    active.store(false, std::memory_order_release);
+    result_val += total;
+  }
+
+  uint32_t checksum() override { return result_val; }
+};
+
+// Binarytrees with nodes from a std::pmr::monotonic_buffer_resource over a
+// buffer sized in prepare() for the whole tree: allocation is a pointer
+// bump, and release() after each iteration rewinds to the start of the
+// buffer in O(1) instead of freeing node by node.
+class BinarytreesPmr : public Benchmark {
+private:
+  struct TreeNode {
+    TreeNode *left = nullptr;
+    TreeNode *right = nullptr;
+    int32_t item;
+
+    explicit TreeNode(int32_t item) : item(item) {}
+  };
+
+  int64_t n;
+  uint32_t result_val;
+  std::unique_ptr<std::byte[]> buffer;
+  std::optional<std::pmr::monotonic_buffer_resource> resource;
+
+  TreeNode *build_tree(std::pmr::polymorphic_allocator<TreeNode> &alloc,
+                       int32_t item, int32_t depth) {
+    TreeNode *node = alloc.new_object<TreeNode>(item);
+    if (depth > 0) {
+      node->left = build_tree(alloc, item - (1 << (depth - 1)), depth - 1);
+      node->right = build_tree(alloc, item + (1 << (depth - 1)), depth - 1);
+    }
+    return node;
+  }
+
+  static uint32_t sum(const TreeNode *node) {
+    uint32_t total = static_cast<uint32_t>(node->item) + 1;
+    if (node->left) {
+      total += sum(node->left);
+    }
+    if (node->right) {
+      total += sum(node->right);
+    }
+    return total;
+  }
+
+public:
+  BinarytreesPmr() : n(config_val(ConfigKey::DEPTH)), result_val(0) {}
+
+  std::string name() const override { return "Binarytrees::Pmr"; }
+
+  int64_t units_per_iteration() const override {
+    return (int64_t{2} << config_val(ConfigKey::DEPTH)) - 1;
+  }
+  const char *unit_name() const override { return "node"; }
+
+  void prepare() override {
+    // A complete tree of depth n has 2^(n+1) - 1 nodes; anything beyond the
+    // buffer would fall back to the default upstream resource.
+    size_t size = ((size_t{2} << n) - 1) * sizeof(TreeNode);
+    buffer = std::make_unique<std::byte[]>(size);
+    resource.emplace(buffer.get(), size);
+  }
+
+  void run(int iteration_id) override {
+    std::pmr::polymorphic_allocator<TreeNode> alloc(&*resource);
+    TreeNode *root = build_tree(alloc, 0, static_cast<int32_t>(n));
+    result_val += sum(root);
+    resource->release();
+  }
+
+  uint32_t checksum() override { return result_val; }
+};
+
+// Binarytrees without child links: the trees are complete, so items are
+// stored in breadth-first (Eytzinger) order where the children of i are at
+// 2i + 1 and 2i + 2. Building fills one level from the previous one and
+// sum() is a linear scan the compiler vectorizes, which separates the cost
+// of the pointer layout from the arithmetic.
+class BinarytreesImplicit : public Benchmark {
+private:
+  std::vector<int32_t> items;
+  int64_t n;
+  uint32_t result_val;
+
+  void build_tree() {
+    items[0] = 0;
+    for (int64_t level = 0; level < n; level++) {
+      int32_t offset = 1 << (n - level - 1);
+      size_t first = (size_t{1} << level) - 1;
+      size_t last = (size_t{2} << level) - 1;
+      for (size_t i = first; i < last; i++) {
+        items[2 * i + 1] = items[i] - offset;
+        items[2 * i + 2] = items[i] + offset;
+      }
+    }
+  }
+
+  uint32_t sum() const {
+    uint32_t total = 0;
+    for (int32_t item : items) {
+      total += static_cast<uint32_t>(item) + 1;
+    }
+    return total;
+  }
+
+public:
+  BinarytreesImplicit() : n(config_val(ConfigKey::DEPTH)), result_val(0) {}
+
+  std::string name() const override { return "Binarytrees::Implicit"; }
+
+  int64_t units_per_iteration() const override {
+    return (int64_t{2} << config_val(ConfigKey::DEPTH)) - 1;
+  }
+  const char *unit_name() const override { return "node"; }
+
+  void prepare() override { items.resize((size_t{2} << n) - 1); }
+
+  void run(int iteration_id) override {
+    build_tree();
+    result_val += sum();
+  }
+
+  uint32_t checksum() override { return result_val; }
+};
+
 class BrainfuckArray : public Benchmark {
 private:
   class Tape {
@@ -479,8 +2606,8 @@ private:
 
 public:
   BrainfuckArray() : result_val(0) {
-    program_text = Helper::config_s(name(), "program");
-    warmup_text = Helper::config_s(name(), "warmup_program");
+    program_text = config_str(ConfigKey::PROGRAM);
+    warmup_text = config_str(ConfigKey::WARMUP_PROGRAM);
   }
 
   std::string name() const override { return "Brainfuck::Array"; }
@@ -627,14 +2754,14 @@ private:
 
 public:
   BrainfuckRecursion() : result_val(0) {
-    text = Helper::config_s(name(), "program");
+    text = config_str(ConfigKey::PROGRAM);
   }
 
   std::string name() const override { return "Brainfuck::Recursion"; }
 
   void warmup() override {
     int64_t prepare_iters = warmup_iterations();
-    std::string warmup_program = Helper::config_s(name(), "warmup_program");
+    std::string warmup_program = config_str(ConfigKey::WARMUP_PROGRAM);
     for (int64_t i = 0; i < prepare_iters; i++) {
       Program(warmup_program).run();
     }
@@ -699,10 +2826,20 @@ private:
   }
 
 public:
-  Fannkuchredux() : n(config_val("n")), result_val(0) {}
+  Fannkuchredux() : n(config_val(ConfigKey::N)), result_val(0) {}
 
   std::string name() const override { return "CLBG::Fannkuchredux"; }
 
+  // Every permutation of n elements is visited once.
+  int64_t units_per_iteration() const override {
+    int64_t perms = 1;
+    for (int64_t i = 2; i <= n; i++) {
+      perms *= i;
+    }
+    return perms;
+  }
+  const char *unit_name() const override { return "perm"; }
+
   void run(int iteration_id) override {
     auto [a, b] = fannkuchredux(static_cast<int>(n));
     result_val += a * 100 + b;
@@ -711,6 +2848,197 @@ public:
   uint32_t checksum() override { return result_val; }
 };
 
+// Vector variants of hot kernels, selected through Isa. They are written
+// with GCC vector extensions so one template serves every width, and keep
+// the scalar operation order per element, so results are bit-identical to
+// the scalar code. On other architectures only the scalar code exists.
+namespace Simd {
+#if defined(__x86_64__) || defined(__i386__)
+#if defined(__clang__)
+#define SIMD_TARGET(isa) __attribute__((target(isa)))
+#else
+// GCC contracts a * b + c into FMA across statements by default, which
+// would round differently from the scalar path.
+#define SIMD_TARGET(isa)                                                       \
+  __attribute__((target(isa), optimize("fp-contract=off")))
+#endif
+
+typedef double f64x2 __attribute__((vector_size(16)));
+typedef double f64x4 __attribute__((vector_size(32)));
+typedef double f64x8 __attribute__((vector_size(64)));
+
+// c = a * b for one row a of the left matrix, in i-k-j order: every c[j]
+// is 0.0 + a[0] * b[0][j] + a[1] * b[1][j] + ..., exactly the scalar dot
+// product, while the j loop runs one vector of columns per instruction.
+template <typename vec>
+[[gnu::always_inline]] inline void
+matmul_row(const double *a, const std::vector<std::vector<double>> &b,
+           double *c, int n) {
+  constexpr int L = sizeof(vec) / sizeof(double);
+
+  std::fill(c, c + n, 0.0);
+  for (int k = 0; k < n; k++) {
+    const double *bk = b[k].data();
+    double aik = a[k];
+    vec av = vec{} + aik;
+    int j = 0;
+    for (; j + L <= n; j += L) {
+      vec bv, cv;
+      std::memcpy(&bv, bk + j, sizeof(vec));
+      std::memcpy(&cv, c + j, sizeof(vec));
+      vec p = av * bv;
+      cv += p;
+      std::memcpy(c + j, &cv, sizeof(vec));
+    }
+    for (; j < n; j++) {
+      double p = aik * bk[j];
+      c[j] += p;
+    }
+  }
+}
+
+// Marks inside[x] for one row of the Mandelbrot set, L pixels at a time.
+// Lanes that escape are frozen, so each lane performs exactly the
+// iterations of the scalar loop.
+template <typename vec>
+[[gnu::always_inline]] inline void mandelbrot_row(int64_t w, int64_t h,
+                                                  int64_t y, int iter,
+                                                  double limit_sq,
+                                                  uint8_t *inside) {
+  using mask = decltype(vec{} <= vec{});
+  constexpr int L = sizeof(vec) / sizeof(double);
+
+  double ci = 2.0 * static_cast<double>(y) / static_cast<double>(h) - 1.0;
+  double fw = static_cast<double>(w);
+  vec civ = vec{} + ci;
+  vec limit = vec{} + limit_sq;
+
+  int64_t x = 0;
+  for (; x + L <= w; x += L) {
+    vec cr;
+    for (int l = 0; l < L; l++) {
+      cr[l] = 2.0 * static_cast<double>(x + l) / fw - 1.5;
+    }
+    vec zr{}, zi{}, tr{}, ti{};
+    for (int i = 0; i < iter; i++) {
+      mask active = (tr + ti) <= limit;
+      bool any = false;
+      for (int l = 0; l < L; l++) {
+        any |= active[l] != 0;
+      }
+      if (!any) {
+        break;
+      }
+      vec t = 2.0 * zr * zi;
+      vec nzi = t + civ;
+      vec nzr = tr - ti + cr;
+      vec ntr = nzr * nzr;
+      vec nti = nzi * nzi;
+      zr = active ? nzr : zr;
+      zi = active ? nzi : zi;
+      tr = active ? ntr : tr;
+      ti = active ? nti : ti;
+    }
+    mask in = (tr + ti) <= limit;
+    for (int l = 0; l < L; l++) {
+      inside[x + l] = in[l] != 0;
+    }
+  }
+
+  for (; x < w; x++) {
+    double cr = 2.0 * static_cast<double>(x) / fw - 1.5;
+    double zr = 0.0, zi = 0.0, tr = 0.0, ti = 0.0;
+    for (int i = 0; i < iter && tr + ti <= limit_sq; i++) {
+      double t = 2.0 * zr * zi;
+      zi = t + ci;
+      zr = tr - ti + cr;
+      tr = zr * zr;
+      ti = zi * zi;
+    }
+    inside[x] = tr + ti <= limit_sq;
+  }
+}
+
+SIMD_TARGET("sse4.2")
+void matmul_row_sse42(const double *a,
+                      const std::vector<std::vector<double>> &b, double *c,
+                      int n) {
+  matmul_row<f64x2>(a, b, c, n);
+}
+
+SIMD_TARGET("avx2")
+void matmul_row_avx2(const double *a,
+                     const std::vector<std::vector<double>> &b, double *c,
+                     int n) {
+  matmul_row<f64x4>(a, b, c, n);
+}
+
+SIMD_TARGET("avx512f")
+void matmul_row_avx512(const double *a,
+                       const std::vector<std::vector<double>> &b, double *c,
+                       int n) {
+  matmul_row<f64x8>(a, b, c, n);
+}
+
+SIMD_TARGET("sse4.2")
+void mandelbrot_row_sse42(int64_t w, int64_t h, int64_t y, int iter,
+                          double limit_sq, uint8_t *inside) {
+  mandelbrot_row<f64x2>(w, h, y, iter, limit_sq, inside);
+}
+
+SIMD_TARGET("avx2")
+void mandelbrot_row_avx2(int64_t w, int64_t h, int64_t y, int iter,
+                         double limit_sq, uint8_t *inside) {
+  mandelbrot_row<f64x4>(w, h, y, iter, limit_sq, inside);
+}
+
+SIMD_TARGET("avx512f")
+void mandelbrot_row_avx512(int64_t w, int64_t h, int64_t y, int iter,
+                           double limit_sq, uint8_t *inside) {
+  mandelbrot_row<f64x8>(w, h, y, iter, limit_sq, inside);
+}
+
+#undef SIMD_TARGET
+#endif
+
+using MatmulRowFn = void (*)(const double *,
+                             const std::vector<std::vector<double>> &,
+                             double *, int);
+using MandelbrotRowFn = void (*)(int64_t, int64_t, int64_t, int, double,
+                                 uint8_t *);
+
+// Kernel for the active ISA level, or nullptr for the scalar code.
+MatmulRowFn matmul_row_kernel() {
+  switch (Isa::active()) {
+#if defined(__x86_64__) || defined(__i386__)
+  case Isa::AVX512:
+    return matmul_row_avx512;
+  case Isa::AVX2:
+    return matmul_row_avx2;
+  case Isa::SSE42:
+    return matmul_row_sse42;
+#endif
+  default:
+    return nullptr;
+  }
+}
+
+MandelbrotRowFn mandelbrot_row_kernel() {
+  switch (Isa::active()) {
+#if defined(__x86_64__) || defined(__i386__)
+  case Isa::AVX512:
+    return mandelbrot_row_avx512;
+  case Isa::AVX2:
+    return mandelbrot_row_avx2;
+  case Isa::SSE42:
+    return mandelbrot_row_sse42;
+#endif
+  default:
+    return nullptr;
+  }
+}
+} // namespace Simd
+
 class Mandelbrot : public Benchmark {
 private:
   static constexpr int ITER = 50;
@@ -721,12 +3049,40 @@ private:
 
 public:
   Mandelbrot() {
-    w = config_val("w");
-    h = config_val("h");
+    w = config_val(ConfigKey::W);
+    h = config_val(ConfigKey::H);
   }
 
   std::string name() const override { return "CLBG::Mandelbrot"; }
 
+  int64_t units_per_iteration() const override {
+    return config_val(ConfigKey::W) * config_val(ConfigKey::H);
+  }
+  const char *unit_name() const override { return "pixel"; }
+
+  bool inside_scalar(int x, int y) const {
+    double tmp_x = static_cast<double>(x);
+    double tmp_y = static_cast<double>(y);
+    volatile double tmp_w = static_cast<double>(w);
+    double tmp_h = static_cast<double>(h);
+
+    double cr = 2.0 * tmp_x / tmp_w - 1.5;
+    double ci = 2.0 * tmp_y / tmp_h - 1.0;
+
+    double zr = 0.0, zi = 0.0;
+    double tr = 0.0, ti = 0.0;
+
+    int i = 0;
+    while (i < ITER && tr + ti <= LIMIT * LIMIT) {
+      zi = 2.0 * zr * zi + ci;
+      zr = tr - ti + cr;
+      tr = zr * zr;
+      ti = zi * zi;
+      i++;
+    }
+    return tr + ti <= LIMIT * LIMIT;
+  }
+
   void run(int iteration_id) override {
     std::ostringstream header;
     header << "P4\n" << w << " " << h << "\n";
@@ -735,31 +3091,20 @@ public:
 
     int bit_num = 0;
     uint8_t byte_acc = 0;
+    auto row_kernel = Simd::mandelbrot_row_kernel();
+    std::vector<uint8_t> inside(static_cast<size_t>(w));
 
     for (int y = 0; y < h; y++) {
+      if (row_kernel) {
+        row_kernel(w, h, y, ITER, LIMIT * LIMIT, inside.data());
+      }
       for (int x = 0; x < w; x++) {
-        double tmp_x = static_cast<double>(x);
-        double tmp_y = static_cast<double>(y);
-        volatile double tmp_w = static_cast<double>(w);
-        double tmp_h = static_cast<double>(h);
-
-        double cr = 2.0 * tmp_x / tmp_w - 1.5;
-        double ci = 2.0 * tmp_y / tmp_h - 1.0;
-
-        double zr = 0.0, zi = 0.0;
-        double tr = 0.0, ti = 0.0;
-
-        int i = 0;
-        while (i < ITER && tr + ti <= LIMIT * LIMIT) {
-          zi = 2.0 * zr * zi + ci;
-          zr = tr - ti + cr;
-          tr = zr * zr;
-          ti = zi * zi;
-          i++;
+        if (!row_kernel) {
+          inside[x] = inside_scalar(x, y);
         }
 
         byte_acc <<= 1;
-        if (tr + ti <= LIMIT * LIMIT) {
+        if (inside[x]) {
           byte_acc |= 0x01;
         }
         bit_num++;
@@ -800,6 +3145,13 @@ protected:
   std::vector<std::vector<double>>
   matmul(int n, const std::vector<std::vector<double>> &a,
          const std::vector<std::vector<double>> &b) {
+    if (auto row_kernel = Simd::matmul_row_kernel()) {
+      std::vector<std::vector<double>> c(n, std::vector<double>(n));
+      for (int i = 0; i < n; i++) {
+        row_kernel(a[i].data(), b, c[i].data(), n);
+      }
+      return c;
+    }
 
     std::vector<std::vector<double>> b_t(n, std::vector<double>(n));
     for (int i = 0; i < n; i++) {
@@ -829,8 +3181,15 @@ public:
 
   std::string name() const override { return "Matmul::Single"; }
 
+  // One multiply-add per (i, j, k).
+  int64_t units_per_iteration() const override {
+    int64_t n = config_val(ConfigKey::N);
+    return n * n * n;
+  }
+  const char *unit_name() const override { return "madd"; }
+
   void prepare() override {
-    int n = static_cast<int>(config_val("n"));
+    int n = static_cast<int>(config_val(ConfigKey::N));
     a = matgen(n);
     b = matgen(n);
   }
@@ -851,12 +3210,16 @@ protected:
   std::vector<std::vector<double>>
   matmul_parallel(int n, const std::vector<std::vector<double>> &a,
                   const std::vector<std::vector<double>> &b) {
-    int num_threads = get_num_threads();
-
-    std::vector<std::vector<double>> b_t(n, std::vector<double>(n));
-    for (int i = 0; i < n; i++) {
-      for (int j = 0; j < n; j++) {
-        b_t[j][i] = b[i][j];
+    int num_threads = threads();
+    auto row_kernel = Simd::matmul_row_kernel();
+
+    std::vector<std::vector<double>> b_t;
+    if (!row_kernel) {
+      b_t.assign(n, std::vector<double>(n));
+      for (int i = 0; i < n; i++) {
+        for (int j = 0; j < n; j++) {
+          b_t[j][i] = b[i][j];
+        }
       }
     }
 
@@ -871,6 +3234,15 @@ protected:
       int end = std::min(start + rows_per_thread, n);
 
       threads.emplace_back([&, start, end]() {
+        TraceSpan span("rows " + std::to_string(start) + "-" +
+                           std::to_string(end),
+                       "task");
+        if (row_kernel) {
+          for (int i = start; i < end; i++) {
+            row_kernel(a[i].data(), b, c[i].data(), n);
+          }
+          return;
+        }
         for (int i = start; i < end; i++) {
           const auto &ai = a[i];
           auto &ci = c[i];
@@ -897,6 +3269,12 @@ public:
 
   std::string name() const override { return "Matmul::T4"; }
 
+  int threads() const override {
+    return OPTIONS.threads > 0 ? OPTIONS.threads : get_num_threads();
+  }
+
+  bool parallel() const override { return true; }
+
   void run(int) override {
     int n = static_cast<int>(a.size());
     auto c = matmul_parallel(n, a, b);
@@ -1090,13 +3468,19 @@ private:
 
 public:
   Spectralnorm() {
-    size_val = config_val("size");
+    size_val = config_val(ConfigKey::SIZE);
     u = std::vector<double>(size_val, 1.0);
     v = std::vector<double>(size_val, 1.0);
   }
 
   std::string name() const override { return "CLBG::Spectralnorm"; }
 
+  // Two A^T A u products per run, each touching the n x n matrix twice.
+  int64_t units_per_iteration() const override {
+    return 4 * config_val(ConfigKey::SIZE) * config_val(ConfigKey::SIZE);
+  }
+  const char *unit_name() const override { return "entry"; }
+
   void run(int iteration_id) override {
     v = eval_AtA_times_u(u);
     u = eval_AtA_times_u(v);
@@ -1130,13 +3514,18 @@ private:
 
 public:
   Base64Encode() : result_val(0) {
-    int64_t n = config_val("size");
+    int64_t n = config_val(ConfigKey::SIZE);
     str = std::string(static_cast<size_t>(n), 'a');
     str2 = base64_encode_simple(str);
   }
 
   std::string name() const override { return "Base64::Encode"; }
 
+  int64_t units_per_iteration() const override {
+    return config_val(ConfigKey::SIZE);
+  }
+  const char *unit_name() const override { return "byte"; }
+
   void run(int iteration_id) override {
     str2 = base64_encode_simple(str);
     result_val += str2.size();
@@ -1182,7 +3571,7 @@ private:
 
 public:
   Base64Decode() : result_val(0) {
-    int64_t n = config_val("size");
+    int64_t n = config_val(ConfigKey::SIZE);
     std::string str = std::string(static_cast<size_t>(n), 'a');
 
     size_t encoded_size = encode_size(str.size());
@@ -1196,6 +3585,11 @@ public:
 
   std::string name() const override { return "Base64::Decode"; }
 
+  int64_t units_per_iteration() const override {
+    return config_val(ConfigKey::SIZE);
+  }
+  const char *unit_name() const override { return "byte"; }
+
   void run(int iteration_id) override {
     str3 = base64_decode_simple(str2);
     result_val += str3.size();
@@ -1244,12 +3638,17 @@ private:
 public:
   int64_t n;
 
-  JsonGenerate() : n(config_val("coords")), result(0) {
+  JsonGenerate() : n(config_val(ConfigKey::COORDS)), result(0) {
     data.reserve(static_cast<size_t>(n));
   }
 
   std::string name() const override { return "Json::Generate"; }
 
+  int64_t units_per_iteration() const override {
+    return config_val(ConfigKey::COORDS);
+  }
+  const char *unit_name() const override { return "coord"; }
+
   void prepare() override {
     for (int64_t i = 0; i < n; i++) {
       double x = custom_round(Helper::next_float(), 8);
@@ -1348,14 +3747,26 @@ public:
 
   std::string name() const override { return "Json::ParseDom"; }
 
+  int64_t units_per_iteration() const override {
+    return config_val(ConfigKey::COORDS);
+  }
+  const char *unit_name() const override { return "coord"; }
+
   void prepare() override {
     JsonGenerate jg;
-    jg.n = config_val("coords");
+    jg.n = config_val(ConfigKey::COORDS);
     jg.prepare();
     jg.run(0);
     text = jg.get_result();
   }
 
+  bool save_prepared(PrepCache::Writer &out) const override {
+    out.write(text);
+    return true;
+  }
+
+  bool load_prepared(PrepCache::Reader &in) override { return in.read(text); }
+
   void run(int iteration_id) override {
     auto padded = simdjson::padded_string(text);
     simdjson::dom::parser parser;
@@ -1397,14 +3808,26 @@ public:
 
   std::string name() const override { return "Json::ParseMapping"; }
 
+  int64_t units_per_iteration() const override {
+    return config_val(ConfigKey::COORDS);
+  }
+  const char *unit_name() const override { return "coord"; }
+
   void prepare() override {
     JsonGenerate jg;
-    jg.n = config_val("coords");
+    jg.n = config_val(ConfigKey::COORDS);
     jg.prepare();
     jg.run(0);
     text = jg.get_result();
   }
 
+  bool save_prepared(PrepCache::Writer &out) const override {
+    out.write(text);
+    return true;
+  }
+
+  bool load_prepared(PrepCache::Reader &in) override { return in.read(text); }
+
   void run(int iteration_id) override {
     simdjson::ondemand::parser parser;
     auto padded = simdjson::padded_string(text);
@@ -1436,10 +3859,15 @@ private:
   uint32_t checksum_val;
 
 public:
-  Sieve() : limit(config_val("limit")), checksum_val(0) {}
+  Sieve() : limit(config_val(ConfigKey::LIMIT)), checksum_val(0) {}
 
   std::string name() const override { return "Etc::Sieve"; }
 
+  int64_t units_per_iteration() const override {
+    return config_val(ConfigKey::LIMIT);
+  }
+  const char *unit_name() const override { return "number"; }
+
   void run(int iteration_id) override {
     size_t sz = static_cast<size_t>(limit);
     std::vector<uint8_t> primes(sz + 1, 1);
@@ -1591,12 +4019,17 @@ private:
 
 public:
   TextRaytracer() : result_val(0) {
-    w = static_cast<int32_t>(config_val("w"));
-    h = static_cast<int32_t>(config_val("h"));
+    w = static_cast<int32_t>(config_val(ConfigKey::W));
+    h = static_cast<int32_t>(config_val(ConfigKey::H));
   }
 
   std::string name() const override { return "Etc::TextRaytracer"; }
 
+  int64_t units_per_iteration() const override {
+    return config_val(ConfigKey::W) * config_val(ConfigKey::H);
+  }
+  const char *unit_name() const override { return "pixel"; }
+
   void run(int iteration_id) override {
     for (int j = 0; j < h; j++) {
       for (int i = 0; i < w; i++) {
@@ -1844,12 +4277,17 @@ private:
 
 public:
   Words() : checksum_val(0) {
-    words = config_val("words");
-    word_len = config_val("word_len");
+    words = config_val(ConfigKey::WORDS);
+    word_len = config_val(ConfigKey::WORD_LEN);
   }
 
   std::string name() const override { return "Etc::Words"; }
 
+  int64_t units_per_iteration() const override {
+    return config_val(ConfigKey::WORDS);
+  }
+  const char *unit_name() const override { return "word"; }
+
   void prepare() override {
     const char chars[] = "abcdefghijklmnopqrstuvwxyz";
     const int char_count = 26;
@@ -1912,11 +4350,14 @@ public:
 
   void prepare() override {
     if (size_val == 0) {
-      size_val = config_val("size");
-      data.reserve(static_cast<size_t>(size_val));
-      for (int64_t i = 0; i < size_val; i++) {
-        data.push_back(Helper::next_int(1'000'000));
-      }
+      size_val = config_val(ConfigKey::SIZE);
+      data.resize(static_cast<size_t>(size_val));
+      Helper::parallel_fill(data.size(), 1,
+                            [&](size_t, size_t begin, size_t end) {
+                              for (size_t i = begin; i < end; i++) {
+                                data[i] = Helper::next_int(1'000'000);
+                              }
+                            });
     }
   }
 
@@ -1927,6 +4368,9 @@ public:
     result_val += t[Helper::next_int(static_cast<int32_t>(size_val))];
   }
 
+  int64_t units_per_iteration() const override { return size_val; }
+  const char *unit_name() const override { return "element"; }
+
   uint32_t checksum() override { return result_val; }
 };
 
@@ -2081,9 +4525,9 @@ public:
   GraphPathBenchmark() : result_val(0) {}
 
   void prepare() override {
-    int vertices = static_cast<int>(config_val("vertices"));
-    int jumps = static_cast<int>(config_val("jumps"));
-    int jump_len = static_cast<int>(config_val("jump_len"));
+    int vertices = static_cast<int>(config_val(ConfigKey::VERTICES));
+    int jumps = static_cast<int>(config_val(ConfigKey::JUMPS));
+    int jump_len = static_cast<int>(config_val(ConfigKey::JUMP_LEN));
     graph = std::make_unique<Graph>(vertices, jumps, jump_len);
     graph->generate_random();
   }
@@ -2261,16 +4705,23 @@ public:
 
   void prepare() override {
     if (size_val == 0) {
-      size_val = config_val("size");
+      size_val = config_val(ConfigKey::SIZE);
       data.resize(static_cast<size_t>(size_val));
-      for (size_t i = 0; i < static_cast<size_t>(size_val); i++) {
-        data[i] = static_cast<uint8_t>(Helper::next_int(256));
-      }
+      Helper::parallel_fill(data.size(), 1,
+                            [&](size_t, size_t begin, size_t end) {
+                              for (size_t i = begin; i < end; i++) {
+                                data[i] =
+                                    static_cast<uint8_t>(Helper::next_int(256));
+                              }
+                            });
     }
   }
 
   void run(int iteration_id) override { result_val += test(); }
 
+  int64_t units_per_iteration() const override { return size_val; }
+  const char *unit_name() const override { return "byte"; }
+
   uint32_t checksum() override { return result_val; }
 };
 
@@ -2470,11 +4921,14 @@ private:
 
 public:
   CacheSimulation()
-      : result_val(5432), values_size(config_val("values")),
-        cache(config_val("size")), hits(0), misses(0) {}
+      : result_val(5432), values_size(config_val(ConfigKey::VALUES)),
+        cache(config_val(ConfigKey::SIZE)), hits(0), misses(0) {}
 
   std::string name() const override { return "Etc::CacheSimulation"; }
 
+  int64_t units_per_iteration() const override { return 1000; }
+  const char *unit_name() const override { return "op"; }
+
   void run(int iteration_id) override {
     for (int i = 0; i < 1000; i++) {
 
@@ -2762,9 +5216,14 @@ private:
 
 public:
   int64_t n;
-  CalculatorAst() : result_val(0), n(config_val("operations")) {}
+  CalculatorAst() : result_val(0), n(config_val(ConfigKey::OPERATIONS)) {}
 
   std::string name() const override { return "Calculator::Ast"; }
+
+  int64_t units_per_iteration() const override {
+    return config_val(ConfigKey::OPERATIONS);
+  }
+  const char *unit_name() const override { return "op"; }
   std::vector<Node> expressions;
 
   void prepare() override { text = generate_random_program(n); }
@@ -2872,10 +5331,17 @@ private:
   std::vector<CalculatorAst::Node> ast;
 
 public:
-  CalculatorInterpreter() : result_val(0) { n = config_val("operations"); }
+  CalculatorInterpreter() : result_val(0) {
+    n = config_val(ConfigKey::OPERATIONS);
+  }
 
   std::string name() const override { return "Calculator::Interpreter"; }
 
+  int64_t units_per_iteration() const override {
+    return config_val(ConfigKey::OPERATIONS);
+  }
+  const char *unit_name() const override { return "op"; }
+
   void prepare() override {
     CalculatorAst ca;
     ca.n = n;
@@ -3012,11 +5478,17 @@ private:
 
 public:
   GameOfLife()
-      : width(static_cast<int32_t>(config_val("w"))),
-        height(static_cast<int32_t>(config_val("h"))), grid(width, height) {}
+      : width(static_cast<int32_t>(config_val(ConfigKey::W))),
+        height(static_cast<int32_t>(config_val(ConfigKey::H))),
+        grid(width, height) {}
 
   std::string name() const override { return "Etc::GameOfLife"; }
 
+  int64_t units_per_iteration() const override {
+    return config_val(ConfigKey::W) * config_val(ConfigKey::H);
+  }
+  const char *unit_name() const override { return "cell"; }
+
   void prepare() override {
     for (auto &row : grid.get_cells()) {
       for (auto &cell : row) {
@@ -3271,13 +5743,18 @@ private:
 
 public:
   MazeGenerator() : result_val(0) {
-    width = static_cast<int32_t>(config_val("w"));
-    height = static_cast<int32_t>(config_val("h"));
+    width = static_cast<int32_t>(config_val(ConfigKey::W));
+    height = static_cast<int32_t>(config_val(ConfigKey::H));
     maze = std::make_unique<Maze>(width, height);
   }
 
   std::string name() const override { return "Maze::Generator"; }
 
+  int64_t units_per_iteration() const override {
+    return config_val(ConfigKey::W) * config_val(ConfigKey::H);
+  }
+  const char *unit_name() const override { return "cell"; }
+
   void prepare() override {}
 
   void run(int) override {
@@ -3355,13 +5832,18 @@ private:
 
 public:
   MazeBFS() : result_val(0) {
-    width = static_cast<int32_t>(config_val("w"));
-    height = static_cast<int32_t>(config_val("h"));
+    width = static_cast<int32_t>(config_val(ConfigKey::W));
+    height = static_cast<int32_t>(config_val(ConfigKey::H));
     maze = std::make_unique<MazeGenerator::Maze>(width, height);
   }
 
   std::string name() const override { return "Maze::BFS"; }
 
+  int64_t units_per_iteration() const override {
+    return config_val(ConfigKey::W) * config_val(ConfigKey::H);
+  }
+  const char *unit_name() const override { return "cell"; }
+
   void prepare() override { maze->generate(); }
 
   void run(int) override {
@@ -3476,13 +5958,18 @@ private:
 
 public:
   MazeAStar() : result_val(0) {
-    width = static_cast<int32_t>(config_val("w"));
-    height = static_cast<int32_t>(config_val("h"));
+    width = static_cast<int32_t>(config_val(ConfigKey::W));
+    height = static_cast<int32_t>(config_val(ConfigKey::H));
     maze = std::make_unique<MazeGenerator::Maze>(width, height);
   }
 
   std::string name() const override { return "Maze::AStar"; }
 
+  int64_t units_per_iteration() const override {
+    return config_val(ConfigKey::W) * config_val(ConfigKey::H);
+  }
+  const char *unit_name() const override { return "cell"; }
+
   void prepare() override { maze->generate(); }
 
   void run(int) override {
@@ -3606,11 +6093,16 @@ public:
   uint32_t result_val;
 
   BWTEncode() : result_val(0), bwt_result({}, 0) {
-    size_val = config_val("size");
+    size_val = config_val(ConfigKey::SIZE);
   }
 
   std::string name() const override { return "Compress::BWTEncode"; }
 
+  int64_t units_per_iteration() const override {
+    return config_val(ConfigKey::SIZE);
+  }
+  const char *unit_name() const override { return "byte"; }
+
   void prepare() override { test_data = generate_test_data(size_val); }
 
   void run(int iteration_id) override {
@@ -3669,11 +6161,16 @@ public:
   uint32_t result_val;
 
   BWTDecode() : result_val(0), bwt_result({}, 0) {
-    size_val = config_val("size");
+    size_val = config_val(ConfigKey::SIZE);
   }
 
   std::string name() const override { return "Compress::BWTDecode"; }
 
+  int64_t units_per_iteration() const override {
+    return config_val(ConfigKey::SIZE);
+  }
+  const char *unit_name() const override { return "byte"; }
+
   void prepare() override {
     BWTEncode encoder;
     encoder.size_val = size_val;
@@ -3683,6 +6180,18 @@ public:
     bwt_result = encoder.bwt_result;
   }
 
+  bool save_prepared(PrepCache::Writer &out) const override {
+    out.write(test_data);
+    out.write(bwt_result.transformed);
+    out.write(bwt_result.original_idx);
+    return true;
+  }
+
+  bool load_prepared(PrepCache::Reader &in) override {
+    return in.read(test_data) && in.read(bwt_result.transformed) &&
+           in.read(bwt_result.original_idx);
+  }
+
   void run(int iteration_id) override {
     inverted = bwt_inverse(bwt_result);
     result_val += static_cast<uint32_t>(inverted.size());
@@ -3828,11 +6337,16 @@ public:
   uint32_t result_val;
 
   HuffEncode() : result_val(0), encoded({}, 0, {}) {
-    size_val = config_val("size");
+    size_val = config_val(ConfigKey::SIZE);
   }
 
   std::string name() const override { return "Compress::HuffEncode"; }
 
+  int64_t units_per_iteration() const override {
+    return config_val(ConfigKey::SIZE);
+  }
+  const char *unit_name() const override { return "byte"; }
+
   void prepare() override { test_data = generate_test_data(size_val); }
 
   void run(int iteration_id) override {
@@ -3895,11 +6409,16 @@ public:
   uint32_t result_val;
 
   HuffDecode() : result_val(0), encoded({}, 0, {}) {
-    size_val = config_val("size");
+    size_val = config_val(ConfigKey::SIZE);
   }
 
   std::string name() const override { return "Compress::HuffDecode"; }
 
+  int64_t units_per_iteration() const override {
+    return config_val(ConfigKey::SIZE);
+  }
+  const char *unit_name() const override { return "byte"; }
+
   void prepare() override {
     test_data = generate_test_data(size_val);
 
@@ -3910,6 +6429,19 @@ public:
     encoded = encoder.encoded;
   }
 
+  bool save_prepared(PrepCache::Writer &out) const override {
+    out.write(test_data);
+    out.write(encoded.data);
+    out.write(encoded.bit_count);
+    out.write(encoded.frequencies);
+    return true;
+  }
+
+  bool load_prepared(PrepCache::Reader &in) override {
+    return in.read(test_data) && in.read(encoded.data) &&
+           in.read(encoded.bit_count) && in.read(encoded.frequencies);
+  }
+
   void run(int iteration_id) override {
     auto tree = HuffEncode::build_huffman_tree(encoded.frequencies);
     decoded = huffman_decode(encoded.data, tree, encoded.bit_count);
@@ -4066,10 +6598,15 @@ public:
   std::vector<uint8_t> test_data;
   ArithEncodedResult encoded;
 
-  ArithEncode() { size_val = config_val("size"); }
+  ArithEncode() { size_val = config_val(ConfigKey::SIZE); }
 
   std::string name() const override { return "Compress::ArithEncode"; }
 
+  int64_t units_per_iteration() const override {
+    return config_val(ConfigKey::SIZE);
+  }
+  const char *unit_name() const override { return "byte"; }
+
   void prepare() override { test_data = generate_test_data(size_val); }
 
   void run(int iteration_id) override {
@@ -4182,10 +6719,15 @@ public:
   std::vector<uint8_t> decoded;
   ArithEncode::ArithEncodedResult encoded;
 
-  ArithDecode() { size_val = config_val("size"); }
+  ArithDecode() { size_val = config_val(ConfigKey::SIZE); }
 
   std::string name() const override { return "Compress::ArithDecode"; }
 
+  int64_t units_per_iteration() const override {
+    return config_val(ConfigKey::SIZE);
+  }
+  const char *unit_name() const override { return "byte"; }
+
   void prepare() override {
     test_data = generate_test_data(size_val);
 
@@ -4196,6 +6738,19 @@ public:
     encoded = encoder.encoded;
   }
 
+  bool save_prepared(PrepCache::Writer &out) const override {
+    out.write(test_data);
+    out.write(encoded.data);
+    out.write(encoded.bit_count);
+    out.write(encoded.frequencies);
+    return true;
+  }
+
+  bool load_prepared(PrepCache::Reader &in) override {
+    return in.read(test_data) && in.read(encoded.data) &&
+           in.read(encoded.bit_count) && in.read(encoded.frequencies);
+  }
+
   void run(int iteration_id) override {
     decoded = arith_decode(encoded);
     result_val += static_cast<uint32_t>(decoded.size());
@@ -4267,10 +6822,15 @@ public:
   std::vector<uint8_t> test_data;
   LZWResult encoded;
 
-  LZWEncode() { size_val = config_val("size"); }
+  LZWEncode() { size_val = config_val(ConfigKey::SIZE); }
 
   std::string name() const override { return "Compress::LZWEncode"; }
 
+  int64_t units_per_iteration() const override {
+    return config_val(ConfigKey::SIZE);
+  }
+  const char *unit_name() const override { return "byte"; }
+
   void prepare() override { test_data = generate_test_data(size_val); }
 
   void run(int iteration_id) override {
@@ -4342,10 +6902,15 @@ public:
   std::vector<uint8_t> decoded;
   LZWEncode::LZWResult encoded;
 
-  LZWDecode() { size_val = config_val("size"); }
+  LZWDecode() { size_val = config_val(ConfigKey::SIZE); }
 
   std::string name() const override { return "Compress::LZWDecode"; }
 
+  int64_t units_per_iteration() const override {
+    return config_val(ConfigKey::SIZE);
+  }
+  const char *unit_name() const override { return "byte"; }
+
   void prepare() override {
     test_data = generate_test_data(size_val);
 
@@ -4356,6 +6921,18 @@ public:
     encoded = encoder.encoded;
   }
 
+  bool save_prepared(PrepCache::Writer &out) const override {
+    out.write(test_data);
+    out.write(encoded.data);
+    out.write(encoded.dict_size);
+    return true;
+  }
+
+  bool load_prepared(PrepCache::Reader &in) override {
+    return in.read(test_data) && in.read(encoded.data) &&
+           in.read(encoded.dict_size);
+  }
+
   void run(int iteration_id) override {
     decoded = lzw_decode(encoded);
     result_val += static_cast<uint32_t>(decoded.size());
@@ -4405,7 +6982,8 @@ private:
 
 public:
   Jaro()
-      : count(config_val("count")), size(config_val("size")), result_val(0) {}
+      : count(config_val(ConfigKey::COUNT)), size(config_val(ConfigKey::SIZE)),
+        result_val(0) {}
 
   void prepare() override { pairs = generate_pair_strings(count, size); }
 
@@ -4484,7 +7062,8 @@ private:
 
 public:
   NGram()
-      : count(config_val("count")), size(config_val("size")), result_val(0) {}
+      : count(config_val(ConfigKey::COUNT)), size(config_val(ConfigKey::SIZE)),
+        result_val(0) {}
 
   void prepare() override {
     pairs = Distance::generate_pair_strings(count, size);
@@ -4540,6 +7119,11 @@ public:
   uint32_t checksum() override { return result_val; }
 
   std::string name() const override { return "Distance::NGram"; }
+
+  int64_t units_per_iteration() const override {
+    return config_val(ConfigKey::COUNT) * config_val(ConfigKey::SIZE);
+  }
+  const char *unit_name() const override { return "char"; }
 };
 } // namespace Distance
 
@@ -4621,8 +7205,13 @@ private:
 public:
   std::string name() const override { return "Etc::LogParser"; }
 
+  int64_t units_per_iteration() const override {
+    return config_val(ConfigKey::LINES_COUNT);
+  }
+  const char *unit_name() const override { return "line"; }
+
   void prepare() override {
-    lines_count = config_val("lines_count");
+    lines_count = config_val(ConfigKey::LINES_COUNT);
     std::string log_builder;
     for (int i = 0; i < lines_count; i++)
       generate_log_line(log_builder, i);
@@ -4735,12 +7324,17 @@ private:
 
 public:
   TemplateRegex() : checksum_val(0), count(0) {
-    count = config_val("count");
+    count = config_val(ConfigKey::COUNT);
     regex = std::make_unique<re2::RE2>(PATTERN);
   }
 
   std::string name() const override { return "Template::Regex"; }
 
+  int64_t units_per_iteration() const override {
+    return static_cast<int64_t>(text.size());
+  }
+  const char *unit_name() const override { return "byte"; }
+
   void prepare() override { generate_template(text, vars, count); }
 
   void run(int iteration_id) override {
@@ -4802,10 +7396,17 @@ private:
   }
 
 public:
-  TemplateParse() : checksum_val(0), count(0) { count = config_val("count"); }
+  TemplateParse() : checksum_val(0), count(0) {
+    count = config_val(ConfigKey::COUNT);
+  }
 
   std::string name() const override { return "Template::Parse"; }
 
+  int64_t units_per_iteration() const override {
+    return static_cast<int64_t>(text.size());
+  }
+  const char *unit_name() const override { return "byte"; }
+
   void prepare() override { generate_template(text, vars, count); }
 
   void run(int iteration_id) override {
@@ -4824,127 +7425,1260 @@ public:
           j++;
         }
 
-        if (j + 1 < len) {
-          std::string key = text.substr(i + 2, j - i - 2);
-          key = trim(key);
+        if (j + 1 < len) {
+          std::string key = text.substr(i + 2, j - i - 2);
+          key = trim(key);
+
+          auto it = vars.find(key);
+          if (it != vars.end()) {
+            result += it->second;
+          }
+          i = j + 2;
+          continue;
+        }
+      }
+
+      result += text[i];
+      i++;
+    }
+
+    rendered = std::move(result);
+    checksum_val += static_cast<uint32_t>(rendered.size());
+  }
+
+  uint32_t checksum() override {
+    return checksum_val + Helper::checksum(rendered);
+  }
+};
+
+class CsvParse : public Benchmark {
+private:
+  struct Point {
+    double x, y, z;
+    Point(double x_, double y_, double z_) : x(x_), y(y_), z(z_) {}
+  };
+
+  int64_t rows;
+  std::string data;
+  uint32_t result_val;
+
+public:
+  CsvParse() : rows(config_val(ConfigKey::ROWS)), result_val(0) {}
+
+  std::string name() const override { return "CSV::Parse"; }
+
+  int64_t units_per_iteration() const override {
+    return config_val(ConfigKey::ROWS);
+  }
+  const char *unit_name() const override { return "row"; }
+
+  void prepare() override {
+    // Three draws per row, so rows are formatted in parallel chunks and
+    // concatenated in order.
+    size_t count = static_cast<size_t>(rows);
+    std::vector<std::string> parts(Helper::fill_chunks(count));
+    Helper::parallel_fill(count, 3, [&](size_t chunk, size_t begin,
+                                        size_t end) {
+      std::ostringstream ss;
+      ss << std::fixed << std::setprecision(10);
+
+      for (size_t i = begin; i < end; i++) {
+        char c = static_cast<char>('A' + (i % 26));
+        double x = Helper::next_float();
+        double z = Helper::next_float();
+        double y = Helper::next_float();
+        ss << '"' << "point " << c << "\\n, \"\"" << (i % 100) << "\"\"\""
+           << ',' << x << ',' << ',' << z << ',' << '"' << '['
+           << (i % 2 == 0 ? "true" : "false") << "\\n, " << (i % 100) << ']'
+           << '"' << ',' << y << '\n';
+      }
+
+      parts[chunk] = ss.str();
+    });
+
+    data.clear();
+    for (const auto &part : parts) {
+      data += part;
+    }
+  }
+
+  void run(int iteration_id) override {
+    (void)iteration_id;
+
+    lazycsv::parser<std::string_view, lazycsv::has_header<false>,
+                    lazycsv::delimiter<','>, lazycsv::quote_char<'"'>>
+        parser(data);
+
+    std::vector<Point> points;
+
+    for (const auto &row : parser) {
+      auto cells = row.cells(1, 3, 5);
+
+      double x = std::stod(std::string(cells[0].trimmed()));
+      double z = std::stod(std::string(cells[2].trimmed()));
+      double y = std::stod(std::string(cells[1].trimmed()));
+
+      points.emplace_back(x, y, z);
+    }
+
+    if (points.empty())
+      return;
+
+    double x_sum = 0.0, y_sum = 0.0, z_sum = 0.0;
+    for (const auto &p : points) {
+      x_sum += p.x;
+      y_sum += p.y;
+      z_sum += p.z;
+    }
+
+    double len = static_cast<double>(points.size());
+    double x_avg = x_sum / len;
+    double y_avg = y_sum / len;
+    double z_avg = z_sum / len;
+
+    result_val += Helper::checksum_f64(x_avg) + Helper::checksum_f64(y_avg) +
+                  Helper::checksum_f64(z_avg);
+  }
+
+  uint32_t checksum() override { return result_val; }
+};
+
+std::string to_lower(const std::string &str) {
+  std::string result = str;
+  std::transform(result.begin(), result.end(), result.begin(),
+                 [](unsigned char c) { return std::tolower(c); });
+  return result;
+}
+
+std::string compiler_info() {
+#if defined(__clang__)
+  return "clang " __clang_version__;
+#elif defined(__GNUC__)
+  return "gcc " __VERSION__;
+#else
+  return "unknown";
+#endif
+}
+
+std::string build_flags() {
+#ifdef BUILD_FLAGS
+  return BUILD_FLAGS;
+#else
+  return "unknown";
+#endif
+}
+
+std::string cpu_model() {
+#if defined(__APPLE__)
+  char buf[256];
+  size_t len = sizeof(buf);
+  if (sysctlbyname("machdep.cpu.brand_string", buf, &len, nullptr, 0) == 0) {
+    return std::string(buf);
+  }
+#else
+  std::ifstream cpuinfo("/proc/cpuinfo");
+  std::string line;
+  while (std::getline(cpuinfo, line)) {
+    if (line.rfind("model name", 0) == 0) {
+      auto pos = line.find(':');
+      if (pos != std::string::npos) {
+        return line.substr(line.find_first_not_of(' ', pos + 1));
+      }
+    }
+  }
+#endif
+  return "unknown";
+}
+
+// Streams one record per finished benchmark as JSON lines and/or CSV rows.
+// Every record is flushed immediately so a crash late in the run keeps the
+// results of everything that completed before it.
+class ResultsWriter {
+private:
+  std::ofstream json_out;
+  std::ofstream csv_out;
+
+public:
+  bool open(const std::string &json_path, const std::string &csv_path) {
+    if (!json_path.empty()) {
+      json_out.open(json_path, std::ios::trunc);
+      if (!json_out.is_open()) {
+        std::cerr << "Cannot open results file: " << json_path << std::endl;
+        return false;
+      }
+    }
+    if (!csv_path.empty()) {
+      csv_out.open(csv_path, std::ios::trunc);
+      if (!csv_out.is_open()) {
+        std::cerr << "Cannot open results file: " << csv_path << std::endl;
+        return false;
+      }
+      csv_out << "name,ok,checksum,expected,prepare_s,warmup_s,run_s,"
+                 "iterations,min_ns,p50_ns,p90_ns,p99_ns,max_ns,threads,"
+                 "compiler,cpu"
+              << std::endl;
+    }
+    return true;
+  }
+
+  bool active() const { return json_out.is_open() || csv_out.is_open(); }
+
+  void flush() {
+    json_out.flush();
+    csv_out.flush();
+  }
+
+  void write(const json &record) {
+    if (json_out.is_open()) {
+      json_out << record.dump() + "\n" << std::flush;
+    }
+    if (csv_out.is_open()) {
+      auto quoted = [](const std::string &v) {
+        std::string out = "\"";
+        for (char c : v) {
+          out += c;
+          if (c == '"') {
+            out += c;
+          }
+        }
+        return out + "\"";
+      };
+      const auto &lat = record["latency_ns"];
+      std::ostringstream row;
+      row << quoted(record["name"]) << ","
+          << (record["checksum"]["ok"].get<bool>() ? 1 : 0) << ","
+          << record["checksum"]["actual"] << ","
+          << record["checksum"]["expected"] << "," << record["prepare_s"]
+          << "," << record["warmup_s"] << "," << record["run_s"] << ","
+          << record["iterations"] << "," << lat["min"] << "," << lat["p50"]
+          << "," << lat["p90"] << "," << lat["p99"] << "," << lat["max"]
+          << "," << record["threads"] << "," << quoted(record["compiler"])
+          << "," << quoted(record["cpu"]) << "\n";
+      csv_out << row.str() << std::flush;
+    }
+  }
+};
+
+ResultsWriter RESULTS;
+
+// Compares per-iteration timings against a --json file from an earlier
+// run with a two-sided Mann-Whitney U test (normal approximation with tie
+// correction). A change is flagged only when it is both significant and
+// larger than MIN_CHANGE on the median.
+class Baseline {
+public:
+  static constexpr double ALPHA = 0.05;
+  static constexpr double MIN_CHANGE = 0.02;
+  static constexpr int64_t DEFAULT_SAMPLES = 20;
+
+  enum Verdict { SAME, REGRESSION, IMPROVEMENT };
+
+  struct Comparison {
+    double base_median = 0.0;
+    double median = 0.0;
+    double change = 0.0;
+    double p_value = 1.0;
+    double effect = 0.0;
+    Verdict verdict = SAME;
+  };
+
+private:
+  static inline std::unordered_map<std::string, std::vector<int64_t>> runs;
+
+  static double median(std::vector<int64_t> v) {
+    std::sort(v.begin(), v.end());
+    size_t n = v.size();
+    return n % 2 == 1 ? static_cast<double>(v[n / 2])
+                      : (static_cast<double>(v[n / 2 - 1]) +
+                         static_cast<double>(v[n / 2])) /
+                            2.0;
+  }
+
+public:
+  static bool load(const std::string &path) {
+    std::ifstream file(path);
+    if (!file.is_open()) {
+      std::cerr << "Cannot open baseline file: " << path << std::endl;
+      return false;
+    }
+
+    std::string line;
+    while (std::getline(file, line)) {
+      if (line.empty()) {
+        continue;
+      }
+      try {
+        auto record = json::parse(line);
+        runs[record["name"].get<std::string>()] =
+            record["timings_ns"].get<std::vector<int64_t>>();
+      } catch (const std::exception &e) {
+        std::cerr << "Skipping bad baseline record: " << e.what()
+                  << std::endl;
+      }
+    }
+    return true;
+  }
+
+  static const std::vector<int64_t> *find(const std::string &name) {
+    auto it = runs.find(name);
+    return it != runs.end() && !it->second.empty() ? &it->second : nullptr;
+  }
+
+  static Comparison compare(const std::vector<int64_t> &base,
+                            const std::vector<int64_t> &current) {
+    Comparison cmp;
+    cmp.base_median = median(base);
+    cmp.median = median(current);
+    cmp.change = cmp.base_median > 0.0 ? cmp.median / cmp.base_median - 1.0
+                                       : 0.0;
+
+    double n1 = static_cast<double>(current.size());
+    double n2 = static_cast<double>(base.size());
+    if (n1 == 0.0 || n2 == 0.0) {
+      return cmp;
+    }
+
+    std::vector<std::pair<int64_t, bool>> all;
+    all.reserve(current.size() + base.size());
+    for (int64_t v : current) {
+      all.emplace_back(v, true);
+    }
+    for (int64_t v : base) {
+      all.emplace_back(v, false);
+    }
+    std::sort(all.begin(), all.end());
+
+    double rank_sum = 0.0;
+    double ties = 0.0;
+    for (size_t i = 0; i < all.size();) {
+      size_t j = i;
+      while (j < all.size() && all[j].first == all[i].first) {
+        j++;
+      }
+      double t = static_cast<double>(j - i);
+      double rank = (static_cast<double>(i + 1) + static_cast<double>(j)) / 2;
+      for (size_t k = i; k < j; k++) {
+        if (all[k].second) {
+          rank_sum += rank;
+        }
+      }
+      ties += t * t * t - t;
+      i = j;
+    }
+
+    double n = n1 + n2;
+    double u = rank_sum - n1 * (n1 + 1.0) / 2.0;
+    double mu = n1 * n2 / 2.0;
+    double sigma =
+        std::sqrt(n1 * n2 / 12.0 * ((n + 1.0) - ties / (n * (n - 1.0))));
+    cmp.effect = 2.0 * u / (n1 * n2) - 1.0;
+    if (sigma > 0.0) {
+      double z = (std::abs(u - mu) - 0.5) / sigma;
+      cmp.p_value = std::erfc(std::max(z, 0.0) / std::sqrt(2.0));
+    }
+
+    if (cmp.p_value < ALPHA && std::abs(cmp.change) > MIN_CHANGE) {
+      cmp.verdict = cmp.change > 0.0 ? REGRESSION : IMPROVEMENT;
+    }
+    return cmp;
+  }
+};
+
+struct RunResult {
+  bool ok = false;
+  double seconds = 0.0;
+  Baseline::Verdict verdict = Baseline::SAME;
+};
+
+RunResult run_benchmark(const BenchFactory &make) {
+  int64_t prepare_start = Helper::now_ns();
+  AllocStats::begin_phase();
+  auto bench = make();
+  Helper::reset();
+  PrepCache::Status cache = prepare_cached(*bench);
+  AllocStats::Phase prepare_allocs = AllocStats::end_phase();
+
+  int64_t warmup_start = Helper::now_ns();
+  Tracer::record("prepare", "phase", prepare_start, warmup_start);
+  AllocStats::begin_phase();
+  bench->warmup();
+  AllocStats::Phase warmup_allocs = AllocStats::end_phase();
+  Helper::reset();
+  int64_t warmup_end = Helper::now_ns();
+  Tracer::record("warmup", "phase", warmup_start, warmup_end);
+
+  bench->timings.reserve(static_cast<size_t>(bench->iterations()));
+  Tracer::reserve_iterations(static_cast<size_t>(bench->iterations()));
+
+  PerfCounters perf;
+  if (OPTIONS.perf) {
+    perf.open();
+  }
+
+  bool profiling = !OPTIONS.profile_dir.empty();
+  if (profiling) {
+    Profiler::start();
+  }
+
+  AllocStats::begin_phase();
+  auto start = std::chrono::steady_clock::now();
+  perf.start();
+  bench->run_all();
+  perf.stop();
+  auto end = std::chrono::steady_clock::now();
+  AllocStats::Phase run_allocs = AllocStats::end_phase();
+
+  if (profiling) {
+    Profiler::stop();
+  }
+
+  std::chrono::duration<double> duration = end - start;
+
+  RunResult result;
+  int64_t run_end = Helper::now_ns();
+  Tracer::record("run", "phase", warmup_end, run_end);
+
+  uint32_t check = bench->checksum();
+  uint32_t expect = static_cast<uint32_t>(bench->expected_checksum());
+  Tracer::record("checksum", "phase", run_end, Helper::now_ns());
+  Tracer::record(bench->name(), "benchmark", prepare_start, Helper::now_ns());
+  if (check == expect) {
+    std::cout << "OK ";
+    result.ok = true;
+  } else {
+    std::cout << "ERR[actual=" << check << ", expected=" << expect << "] ";
+  }
+
+  std::cout << "in " << std::fixed << std::setprecision(3)
+            << duration.count() << "s" << std::endl;
+
+  if (cache != PrepCache::UNCACHED) {
+    std::cout << "  cache: " << (cache == PrepCache::HIT ? "hit" : "stored")
+              << " prepare=" << format_ns(warmup_start - prepare_start)
+              << std::endl;
+  }
+
+  if (OPTIONS.adaptive) {
+    // The fixed-count pass above verified the checksum; timings now come
+    // from a fresh instance that warms up and samples until it converges.
+    bench = make();
+    Helper::reset();
+    prepare_cached(*bench);
+    int64_t budget_ns = static_cast<int64_t>(OPTIONS.budget * 1e9);
+    auto [warmup_iters, settled] =
+        bench->warmup_adaptive(Helper::now_ns() + budget_ns / 2);
+    Helper::reset();
+    bool converged = bench->run_adaptive(OPTIONS.target_ci,
+                                         Helper::now_ns() + budget_ns / 2);
+
+    const auto &h = bench->latency;
+    double half_width =
+        t_quantile_95(static_cast<double>(h.count()) - 1.0) * h.stddev() /
+        std::sqrt(static_cast<double>(h.count()));
+    std::cout << "  adaptive: warmup=" << warmup_iters
+              << (settled ? " (steady)" : " (budget)")
+              << " samples=" << h.count()
+              << " mean=" << format_ns(std::llround(h.mean())) << " +-"
+              << std::fixed << std::setprecision(2)
+              << (h.mean() > 0.0 ? half_width / h.mean() * 100.0 : 0.0)
+              << "%" << (converged ? "" : " (budget exhausted)") << std::endl;
+  }
+
+  for (int64_t i = bench->iterations();
+       static_cast<int64_t>(bench->timings.size()) < OPTIONS.min_samples;
+       i++) {
+    bench->run_timed(i);
+  }
+
+  if (const auto *base = Baseline::find(bench->name())) {
+    auto cmp = Baseline::compare(*base, bench->timings);
+    result.verdict = cmp.verdict;
+    std::cout << "  baseline: p50 " << format_ns(std::llround(cmp.base_median))
+              << " -> " << format_ns(std::llround(cmp.median)) << " ("
+              << std::showpos << std::fixed << std::setprecision(1)
+              << cmp.change * 100.0 << "%" << std::noshowpos
+              << "), p=" << std::setprecision(4) << cmp.p_value
+              << ", effect=" << std::setprecision(2) << cmp.effect;
+    if (cmp.verdict == Baseline::REGRESSION) {
+      std::cout << " REGRESSION";
+    } else if (cmp.verdict == Baseline::IMPROVEMENT) {
+      std::cout << " IMPROVEMENT";
+    }
+    std::cout << std::endl;
+  } else if (!OPTIONS.baseline_path.empty()) {
+    std::cout << "  baseline: no data" << std::endl;
+  }
+
+  if (OPTIONS.stats) {
+    const auto &h = bench->latency;
+    std::cout << "  iters=" << h.count() << " min=" << format_ns(h.min())
+              << " p50=" << format_ns(h.percentile(50))
+              << " p90=" << format_ns(h.percentile(90))
+              << " p99=" << format_ns(h.percentile(99))
+              << " max=" << format_ns(h.max()) << " cv=" << std::fixed
+              << std::setprecision(1) << h.cv() * 100.0 << "%"
+              << std::endl;
+  }
+
+  if (OPTIONS.perf) {
+    if (perf.any()) {
+      double iters = static_cast<double>(bench->iterations());
+      std::cout << "  perf:";
+      if (perf.available(PerfCounters::CYCLES) &&
+          perf.available(PerfCounters::INSTRUCTIONS) &&
+          perf.value(PerfCounters::CYCLES) > 0) {
+        std::cout << " ipc=" << std::fixed << std::setprecision(2)
+                  << perf.value(PerfCounters::INSTRUCTIONS) /
+                         perf.value(PerfCounters::CYCLES);
+      }
+      for (int e = 0; e < PerfCounters::EVENT_COUNT; e++) {
+        if (perf.available(e)) {
+          std::cout << " " << PerfCounters::event_name(e)
+                    << "/iter=" << std::fixed << std::setprecision(0)
+                    << perf.value(e) / iters;
+        }
+      }
+      std::cout << std::endl;
+    } else {
+      std::cout << "  perf: unavailable (" << perf.last_error() << ")"
+                << std::endl;
+    }
+  }
+
+  if (profiling) {
+    std::string file = bench->name();
+    std::replace(file.begin(), file.end(), ':', '_');
+    fs::path path = fs::path(OPTIONS.profile_dir) / (file + ".folded");
+    std::error_code ec;
+    fs::create_directories(OPTIONS.profile_dir, ec);
+    if (Profiler::write_folded(path.string())) {
+      std::cout << "  profile: " << Profiler::sample_count() << " samples";
+      if (Profiler::dropped() > 0) {
+        std::cout << " (" << Profiler::dropped() << " dropped)";
+      }
+      std::cout << " -> " << path.string() << std::endl;
+    } else {
+      std::cout << "  profile: cannot write " << path.string() << std::endl;
+    }
+  }
+
+  if (OPTIONS.alloc) {
+    auto phase = [](const char *label, const AllocStats::Phase &p) {
+      std::cout << " " << label << "=" << p.count << "/"
+                << format_bytes(p.bytes) << "/peak "
+                << format_bytes(p.peak);
+    };
+    int64_t iters = std::max<int64_t>(bench->iterations(), 1);
+    std::cout << "  alloc:";
+    phase("prepare", prepare_allocs);
+    phase("warmup", warmup_allocs);
+    phase("run", run_allocs);
+    std::cout << " allocs/iter=" << std::fixed << std::setprecision(2)
+              << static_cast<double>(run_allocs.count) /
+                     static_cast<double>(iters)
+              << " bytes/iter="
+              << format_bytes(static_cast<double>(run_allocs.bytes) /
+                              static_cast<double>(iters));
+    if (int64_t units = bench->units_per_iteration(); units > 0) {
+      std::cout << " allocs/" << bench->unit_name() << "="
+                << static_cast<double>(run_allocs.count) /
+                       static_cast<double>(iters * units);
+    }
+    std::cout << std::endl;
+  }
+
+  result.seconds = duration.count();
+
+  if (RESULTS.active()) {
+    const auto &h = bench->latency;
+    json record = {
+        {"name", bench->name()},
+        {"config", Config::to_json(bench->name())},
+        {"startup_s", STARTUP_NS / 1e9},
+        {"prepare_s", (warmup_start - prepare_start) / 1e9},
+        {"warmup_s", (warmup_end - warmup_start) / 1e9},
+        {"run_s", duration.count()},
+        {"iterations", bench->timings.size()},
+        {"timings_ns", bench->timings},
+        {"latency_ns",
+         {{"min", h.min()},
+          {"p50", h.percentile(50)},
+          {"p90", h.percentile(90)},
+          {"p99", h.percentile(99)},
+          {"max", h.max()},
+          {"mean", h.mean()},
+          {"cv", h.cv()}}},
+        {"checksum",
+         {{"ok", result.ok}, {"actual", check}, {"expected", expect}}},
+        {"threads", bench->threads()},
+        {"isa", Isa::name(Isa::active())},
+        {"compiler", compiler_info()},
+        {"flags", build_flags()},
+        {"cpu", cpu_model()}};
+    RESULTS.write(record);
+  }
+
+  bench.reset();
+  Tracer::flush();
+  std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  return result;
+}
+
+struct ChildReport {
+  RunResult result;
+  int64_t maxrss_kb;
+  int64_t minflt;
+  int64_t majflt;
+  int64_t nvcsw;
+  int64_t nivcsw;
+};
+
+// Child side of a forked run: runs the benchmark, adds getrusage() figures
+// and sends the report to the parent, then exits without unwinding.
+[[noreturn]] void run_child(const BenchFactory &make, int report_fd) {
+  ChildReport report{};
+  report.result = run_benchmark(make);
+
+  rusage usage{};
+  getrusage(RUSAGE_SELF, &usage);
+#ifdef __APPLE__
+  report.maxrss_kb = usage.ru_maxrss / 1024;
+#else
+  report.maxrss_kb = usage.ru_maxrss;
+#endif
+  report.minflt = usage.ru_minflt;
+  report.majflt = usage.ru_majflt;
+  report.nvcsw = usage.ru_nvcsw;
+  report.nivcsw = usage.ru_nivcsw;
+
+  std::cout.flush();
+  ssize_t written = write(report_fd, &report, sizeof(report));
+  _exit(written == sizeof(report) ? 0 : 1);
+}
+
+bool read_report(int fd, ChildReport &report) {
+  size_t got = 0;
+  while (got < sizeof(report)) {
+    ssize_t n = read(fd, reinterpret_cast<char *>(&report) + got,
+                     sizeof(report) - got);
+    if (n <= 0) {
+      break;
+    }
+    got += static_cast<size_t>(n);
+  }
+  return got == sizeof(report);
+}
+
+void print_child_result(bool reported, const ChildReport &report,
+                        int status) {
+  if (!reported) {
+    std::cout << "ERR[child ";
+    if (WIFSIGNALED(status)) {
+      std::cout << "killed by signal " << WTERMSIG(status);
+    } else {
+      std::cout << "exited with " << WEXITSTATUS(status);
+    }
+    std::cout << "]" << std::endl;
+    return;
+  }
+
+  std::cout << "  rusage: maxrss=" << format_bytes(report.maxrss_kb * 1024)
+            << " minflt=" << report.minflt << " majflt=" << report.majflt
+            << " nvcsw=" << report.nvcsw << " nivcsw=" << report.nivcsw
+            << std::endl;
+}
 
-          auto it = vars.find(key);
-          if (it != vars.end()) {
-            result += it->second;
-          }
-          i = j + 2;
-          continue;
-        }
-      }
+void flush_outputs() {
+  std::cout.flush();
+  RESULTS.flush();
+  Tracer::flush();
+}
 
-      result += text[i];
-      i++;
-    }
+// Runs one benchmark in a forked child so its heap, page cache footprint and
+// peak RSS are its own. The child prints its report as usual and sends the
+// outcome plus getrusage() figures back over a pipe.
+RunResult run_forked(const BenchFactory &make) {
+  flush_outputs();
+  int fds[2];
+  if (pipe(fds) != 0) {
+    std::cerr << "pipe failed: " << std::strerror(errno) << std::endl;
+    return run_benchmark(make);
+  }
 
-    rendered = std::move(result);
-    checksum_val += static_cast<uint32_t>(rendered.size());
+  pid_t pid = fork();
+  if (pid < 0) {
+    std::cerr << "fork failed: " << std::strerror(errno) << std::endl;
+    close(fds[0]);
+    close(fds[1]);
+    return run_benchmark(make);
   }
 
-  uint32_t checksum() override {
-    return checksum_val + Helper::checksum(rendered);
+  if (pid == 0) {
+    close(fds[0]);
+    run_child(make, fds[1]);
   }
-};
 
-class CsvParse : public Benchmark {
-private:
-  struct Point {
-    double x, y, z;
-    Point(double x_, double y_, double z_) : x(x_), y(y_), z(z_) {}
+  close(fds[1]);
+  ChildReport report{};
+  bool reported = read_report(fds[0], report);
+  close(fds[0]);
+
+  int status = 0;
+  waitpid(pid, &status, 0);
+
+  print_child_result(reported, report, status);
+  return reported ? report.result : RunResult{};
+}
+
+// Starts `copies` forked instances of one benchmark, lets each prepare and
+// warm up on its own (with its own Helper state), then releases them all at
+// once and collects per-copy run_all() time and checksum status.
+std::vector<std::pair<bool, double>> run_copies(const BenchFactory &make,
+                                                int copies) {
+  struct CopyReport {
+    int32_t index;
+    int32_t ok;
+    double seconds;
   };
 
-  int64_t rows;
-  std::string data;
-  uint32_t result_val;
+  int ready[2];
+  int go[2];
+  int reports[2];
+  if (pipe(ready) != 0 || pipe(go) != 0 || pipe(reports) != 0) {
+    std::cerr << "pipe failed: " << std::strerror(errno) << std::endl;
+    std::exit(1);
+  }
 
-public:
-  CsvParse() : rows(config_val("rows")), result_val(0) {}
+  flush_outputs();
+  std::vector<pid_t> pids;
+  for (int i = 0; i < copies; i++) {
+    pid_t pid = fork();
+    if (pid < 0) {
+      std::cerr << "fork failed: " << std::strerror(errno) << std::endl;
+      break;
+    }
+    if (pid == 0) {
+      close(ready[0]);
+      close(go[1]);
+      close(reports[0]);
 
-  std::string name() const override { return "CSV::Parse"; }
+      // Constructors may draw from Helper too; start every copy the same way.
+      Helper::reset();
+      auto bench = make();
+      Helper::reset();
+      prepare_cached(*bench);
+      bench->warmup();
+      Helper::reset();
 
-  void prepare() override {
-    std::ostringstream ss;
-    ss << std::fixed << std::setprecision(10);
+      char byte = 1;
+      char unused;
+      ssize_t io = write(ready[1], &byte, 1);
+      close(ready[1]);
+      io = read(go[0], &unused, 1);
+      (void)io;
+
+      auto start = std::chrono::steady_clock::now();
+      bench->run_all();
+      auto end = std::chrono::steady_clock::now();
+      std::chrono::duration<double> duration = end - start;
 
-    for (int i = 0; i < rows; i++) {
-      char c = 'A' + (i % 26);
-      double x = Helper::next_float();
-      double z = Helper::next_float();
-      double y = Helper::next_float();
-      ss << '"' << "point " << c << "\\n, \"\"" << (i % 100) << "\"\"\"" << ','
-         << x << ',' << ',' << z << ',' << '"' << '['
-         << (i % 2 == 0 ? "true" : "false") << "\\n, " << (i % 100) << ']'
-         << '"' << ',' << y << '\n';
+      CopyReport report{i,
+                        bench->checksum() == static_cast<uint32_t>(
+                                                 bench->expected_checksum()),
+                        duration.count()};
+      ssize_t written = write(reports[1], &report, sizeof(report));
+      _exit(written == sizeof(report) ? 0 : 1);
+    }
+    pids.push_back(pid);
+  }
+  close(ready[1]);
+  close(go[0]);
+  close(reports[1]);
+
+  // Wait until every copy has finished its warmup, then start them together
+  // by closing the pipe they block on. Copies close their end of `ready`
+  // once they have written to it, so EOF before every byte arrived, or a
+  // copy that has already exited, means one died in prepare() or warmup().
+  // The rest are then killed and every copy counts as failed.
+  std::vector<std::pair<bool, double>> results(pids.size(), {false, 0.0});
+  std::vector<bool> reaped(pids.size(), false);
+  size_t ready_count = 0;
+  bool failed = false;
+  while (ready_count < pids.size() && !failed) {
+    pollfd pfd{ready[0], POLLIN, 0};
+    if (poll(&pfd, 1, 100) > 0) {
+      char byte;
+      ssize_t n = read(ready[0], &byte, 1);
+      if (n == 1) {
+        ready_count++;
+        continue;
+      }
+      failed = n == 0;
+    }
+    for (size_t i = 0; i < pids.size(); i++) {
+      if (!reaped[i] && waitpid(pids[i], nullptr, WNOHANG) == pids[i]) {
+        reaped[i] = true;
+        failed = true;
+      }
     }
+  }
+  if (failed) {
+    std::cerr << "rate: a copy exited before starting, " << ready_count
+              << "/" << pids.size() << " were ready" << std::endl;
+    for (size_t i = 0; i < pids.size(); i++) {
+      if (!reaped[i]) {
+        kill(pids[i], SIGKILL);
+        waitpid(pids[i], nullptr, 0);
+      }
+    }
+    close(go[1]);
+    close(ready[0]);
+    close(reports[0]);
+    return results;
+  }
+  close(go[1]);
 
-    data = ss.str();
+  CopyReport report{};
+  while (read(reports[0], &report, sizeof(report)) == sizeof(report)) {
+    if (report.index >= 0 && report.index < static_cast<int>(pids.size())) {
+      results[report.index] = {report.ok != 0, report.seconds};
+    }
+  }
+  close(ready[0]);
+  close(reports[0]);
+  for (size_t i = 0; i < pids.size(); i++) {
+    if (!reaped[i]) {
+      waitpid(pids[i], nullptr, 0);
+    }
   }
+  return results;
+}
 
-  void run(int iteration_id) override {
-    (void)iteration_id;
+// SPECrate-style throughput for --rate: one solo copy for reference, then N
+// copies at once. Reports aggregate iterations per second and how much each
+// copy slowed down relative to running alone.
+RunResult run_rate(const BenchFactory &make) {
+  int copies = OPTIONS.rate;
+  std::cout << "rate x" << copies << std::endl;
+
+  auto solo = run_copies(make, 1);
+  auto all = run_copies(make, copies);
+  double iters = static_cast<double>(make()->iterations());
+
+  RunResult result;
+  result.ok = !solo.empty() && solo[0].first &&
+              static_cast<int>(all.size()) == copies;
+  result.seconds = solo.empty() ? 0.0 : solo[0].second;
+
+  double rate = 0.0;
+  double total = 0.0;
+  double slowest = 0.0;
+  for (const auto &[ok, seconds] : all) {
+    result.ok = result.ok && ok;
+    total += seconds;
+    slowest = std::max(slowest, seconds);
+    if (seconds > 0.0) {
+      rate += iters / seconds;
+    }
+  }
+  double mean = all.empty() ? 0.0 : total / static_cast<double>(all.size());
+  double solo_time = result.seconds;
+
+  std::cout << "  solo=" << std::fixed << std::setprecision(3) << solo_time
+            << "s mean=" << mean << "s max=" << slowest << "s";
+  if (solo_time > 0.0) {
+    std::cout << " slowdown=" << std::setprecision(2) << mean / solo_time
+              << "x (max " << slowest / solo_time << "x) rate="
+              << format_count(rate) << " iter/s (solo "
+              << format_count(iters / solo_time) << " iter/s)";
+  }
+  std::cout << (result.ok ? " OK" : " ERR") << std::endl;
+  return result;
+}
 
-    lazycsv::parser<std::string_view, lazycsv::has_header<false>,
-                    lazycsv::delimiter<','>, lazycsv::quote_char<'"'>>
-        parser(data);
+// One logical CPU per physical core that this process may run on, so that
+// concurrent jobs never share a core with an SMT sibling.
+std::vector<int> physical_cores() {
+  std::vector<int> cores;
+#ifdef __linux__
+  cpu_set_t allowed;
+  CPU_ZERO(&allowed);
+  if (sched_getaffinity(0, sizeof(allowed), &allowed) == 0) {
+    std::unordered_set<std::string> seen;
+    for (int cpu = 0; cpu < CPU_SETSIZE; cpu++) {
+      if (!CPU_ISSET(cpu, &allowed)) {
+        continue;
+      }
+      std::ifstream topology("/sys/devices/system/cpu/cpu" +
+                             std::to_string(cpu) +
+                             "/topology/thread_siblings_list");
+      std::string siblings;
+      if (!(topology >> siblings)) {
+        siblings = std::to_string(cpu);
+      }
+      if (seen.insert(siblings).second) {
+        cores.push_back(cpu);
+      }
+    }
+  }
+#endif
+  if (cores.empty()) {
+    int n = std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+    for (int cpu = 0; cpu < n; cpu++) {
+      cores.push_back(cpu);
+    }
+  }
+  return cores;
+}
 
-    std::vector<Point> points;
+// --jobs scheduler: single-threaded benchmarks run concurrently in forked
+// children, each pinned to its own physical core; parallel benchmarks wait
+// for every other job to finish and then run alone. Child output goes to a
+// temporary file and is replayed in config order.
+std::vector<RunResult>
+run_concurrent(const std::vector<std::pair<std::string, BenchFactory>> &benches,
+               int jobs) {
+  struct Job {
+    bool classified = false;
+    bool exclusive = false;
+    int cpu = -1;
+    pid_t pid = -1;
+    int report_fd = -1;
+    FILE *output = nullptr;
+    bool done = false;
+    bool reported = false;
+    ChildReport report{};
+    int status = 0;
+  };
 
-    for (const auto &row : parser) {
-      auto cells = row.cells(1, 3, 5);
+  std::vector<int> free_cpus = physical_cores();
+  if (static_cast<int>(free_cpus.size()) > jobs) {
+    free_cpus.resize(static_cast<size_t>(jobs));
+  }
+  std::reverse(free_cpus.begin(), free_cpus.end());
+
+  std::vector<Job> queue(benches.size());
+  std::vector<RunResult> results(benches.size());
+  size_t next = 0;
+  size_t printed = 0;
+  int running = 0;
+  bool exclusive_running = false;
+
+  while (printed < benches.size()) {
+    while (next < benches.size()) {
+      Job &job = queue[next];
+      if (!job.classified) {
+        // Built only to ask parallel() and freed before the fork, so the
+        // parent holds at most one benchmark at a time. Some constructors
+        // draw from Helper; give every child the state a --fork child gets.
+        job.exclusive = benches[next].second()->parallel();
+        job.classified = true;
+        Helper::reset();
+      }
+      if (job.exclusive ? running > 0
+                        : exclusive_running || free_cpus.empty()) {
+        break;
+      }
+      if (!job.exclusive) {
+        job.cpu = free_cpus.back();
+        free_cpus.pop_back();
+      }
+
+      int fds[2];
+      job.output = std::tmpfile();
+      if (job.output == nullptr || pipe(fds) != 0) {
+        std::cerr << "cannot start " << benches[next].first << ": "
+                  << std::strerror(errno) << std::endl;
+        std::exit(1);
+      }
+
+      flush_outputs();
+      job.pid = fork();
+      if (job.pid == 0) {
+        close(fds[0]);
+        dup2(fileno(job.output), STDOUT_FILENO);
+#ifdef __linux__
+        if (job.cpu >= 0) {
+          cpu_set_t set;
+          CPU_ZERO(&set);
+          CPU_SET(job.cpu, &set);
+          sched_setaffinity(0, sizeof(set), &set);
+        }
+#endif
+        std::cout << benches[next].first << ": ";
+        run_child(benches[next].second, fds[1]);
+      }
+      close(fds[1]);
+      job.report_fd = fds[0];
+      running++;
+      exclusive_running = job.exclusive;
+      next++;
+    }
 
-      double x = std::stod(std::string(cells[0].trimmed()));
-      double z = std::stod(std::string(cells[2].trimmed()));
-      double y = std::stod(std::string(cells[1].trimmed()));
+    int status = 0;
+    pid_t pid = waitpid(-1, &status, 0);
+    if (pid < 0) {
+      std::cerr << "waitpid failed: " << std::strerror(errno) << std::endl;
+      std::exit(1);
+    }
+    for (auto &job : queue) {
+      if (job.pid != pid || job.done) {
+        continue;
+      }
+      job.done = true;
+      job.status = status;
+      job.reported = read_report(job.report_fd, job.report);
+      close(job.report_fd);
+      if (job.cpu >= 0) {
+        free_cpus.push_back(job.cpu);
+      }
+      running--;
+      exclusive_running = false;
+    }
 
-      points.emplace_back(x, y, z);
+    while (printed < benches.size() && queue[printed].done) {
+      Job &job = queue[printed];
+      std::rewind(job.output);
+      char buf[4096];
+      size_t n;
+      while ((n = std::fread(buf, 1, sizeof(buf), job.output)) > 0) {
+        std::cout.write(buf, static_cast<std::streamsize>(n));
+      }
+      std::fclose(job.output);
+      if (!job.reported) {
+        std::cout << benches[printed].first << ": ";
+      }
+      print_child_result(job.reported, job.report, job.status);
+      results[printed] = job.reported ? job.report.result : RunResult{};
+      printed++;
     }
+  }
+  return results;
+}
 
-    if (points.empty())
-      return;
+// Re-runs one benchmark over a geometric range of one config field and
+// reports time per iteration plus, for benchmarks that count their work
+// (units_per_iteration), throughput in those units. Work per unit stays
+// constant while the size grows, so a drop shows where the workload falls
+// out of a cache level. Checksums only hold for the configured size, so they
+// are not verified here.
+void run_sweep(const std::string &bench_name, const BenchFactory &make) {
+  const std::string &field = OPTIONS.sweep_field;
+  const Config::Value *current = Config::get(bench_name, field);
+  if (!current) {
+    std::cout << "no field '" << field << "', skipped" << std::endl;
+    return;
+  }
+  std::cout << "sweep " << field << std::endl;
+
+  Config::Section &section = Config::section(bench_name);
+  int key = Config::key(field);
+  Config::Value original = *current;
+  double last = static_cast<double>(OPTIONS.sweep_to) * (1.0 + 1e-9);
+  for (double v = static_cast<double>(OPTIONS.sweep_from); v <= last;
+       v *= OPTIONS.sweep_factor) {
+    int64_t value = std::llround(v);
+    section.set(key, value);
+
+    auto bench = make();
+    Helper::reset();
+    prepare_cached(*bench);
+    bench->warmup();
+    Helper::reset();
+
+    auto start = std::chrono::steady_clock::now();
+    bench->run_all();
+    auto end = std::chrono::steady_clock::now();
+    std::chrono::duration<double> duration = end - start;
+
+    double iters = static_cast<double>(bench->iterations());
+    double per_iter = duration.count() / iters;
+    std::cout << "  " << field << "=" << value << " time=" << std::fixed
+              << std::setprecision(3) << duration.count()
+              << "s per_iter=" << format_ns(std::llround(per_iter * 1e9));
+    if (int64_t units = bench->units_per_iteration(); units > 0) {
+      std::cout << " throughput="
+                << format_count(static_cast<double>(units) / per_iter) << " "
+                << bench->unit_name() << "/s";
+    }
+    std::cout << std::endl;
+  }
+  section.set(key, original);
+}
 
-    double x_sum = 0.0, y_sum = 0.0, z_sum = 0.0;
-    for (const auto &p : points) {
-      x_sum += p.x;
-      y_sum += p.y;
-      z_sum += p.z;
+// Runs a parallel benchmark with 1..N threads and reports speedup over the
+// single-threaded run, parallel efficiency and the Karp-Flatt experimentally
+// determined serial fraction e = (1/S - 1/p) / (1 - 1/p).
+void run_thread_sweep(const BenchFactory &make) {
+  if (!make()->parallel()) {
+    std::cout << "single-threaded, skipped" << std::endl;
+    return;
+  }
+  std::cout << "threads 1.." << OPTIONS.thread_sweep << std::endl;
+
+  int saved = OPTIONS.threads;
+  double base_time = 0.0;
+  for (int p = 1; p <= OPTIONS.thread_sweep; p++) {
+    OPTIONS.threads = p;
+
+    auto bench = make();
+    Helper::reset();
+    prepare_cached(*bench);
+    bench->warmup();
+    Helper::reset();
+
+    auto start = std::chrono::steady_clock::now();
+    bench->run_all();
+    auto end = std::chrono::steady_clock::now();
+    std::chrono::duration<double> duration = end - start;
+
+    bool ok = bench->checksum() ==
+              static_cast<uint32_t>(bench->expected_checksum());
+    if (p == 1) {
+      base_time = duration.count();
     }
+    double speedup = duration.count() > 0.0 ? base_time / duration.count() : 0;
 
-    double len = static_cast<double>(points.size());
-    double x_avg = x_sum / len;
-    double y_avg = y_sum / len;
-    double z_avg = z_sum / len;
+    std::cout << "  threads=" << p << (ok ? " OK" : " ERR") << " time="
+              << std::fixed << std::setprecision(3) << duration.count()
+              << "s speedup=" << std::setprecision(2) << speedup
+              << " efficiency=" << std::setprecision(1)
+              << speedup / p * 100.0 << "%";
+    if (p > 1 && speedup > 0.0) {
+      double pd = static_cast<double>(p);
+      double serial = (1.0 / speedup - 1.0 / pd) / (1.0 - 1.0 / pd);
+      std::cout << " serial_fraction=" << std::setprecision(3) << serial;
+    }
+    std::cout << std::endl;
+  }
+  OPTIONS.threads = saved;
+}
 
-    result_val += Helper::checksum_f64(x_avg) + Helper::checksum_f64(y_avg) +
-                  Helper::checksum_f64(z_avg);
+// Mean and 95% confidence half-width of a sample.
+std::pair<double, double> mean_ci(const std::vector<double> &v) {
+  double n = static_cast<double>(v.size());
+  double mean = 0.0;
+  for (double x : v) {
+    mean += x;
+  }
+  mean /= n;
+  if (v.size() < 2) {
+    return {mean, 0.0};
   }
+  double var = 0.0;
+  for (double x : v) {
+    var += (x - mean) * (x - mean);
+  }
+  var /= n - 1.0;
+  return {mean, t_quantile_95(n - 1.0) * std::sqrt(var / n)};
+}
 
-  uint32_t checksum() override { return result_val; }
-};
+// Interleaved A/B comparison: every round runs one iteration of each
+// benchmark in a freshly shuffled order, so frequency scaling, thermal
+// drift and background noise hit all variants alike. Each benchmark keeps
+// its own Helper generator state across rounds, as if it ran alone. The
+// first benchmark is the reference; the others are reported as paired
+// per-round differences against it, with 95% confidence intervals for the
+// time difference and for the ratio (from the mean log ratio).
+void run_ab(const std::vector<std::pair<std::string, BenchFactory>> &benches) {
+  static constexpr int64_t AB_ROUNDS = 30;
+
+  size_t k = benches.size();
+  std::vector<std::unique_ptr<Benchmark>> instances;
+  std::vector<int64_t> states;
+  int64_t rounds = OPTIONS.min_samples;
+  for (const auto &[name, make] : benches) {
+    Helper::reset();
+    auto bench = make();
+    Helper::reset();
+    prepare_cached(*bench);
+    bench->warmup();
+    Helper::reset();
+    if (OPTIONS.min_samples == 0) {
+      rounds = std::max({rounds, AB_ROUNDS, bench->iterations()});
+    }
+    bench->timings.reserve(static_cast<size_t>(rounds));
+    Tracer::reserve_iterations(static_cast<size_t>(rounds));
+    states.push_back(Helper::state());
+    instances.push_back(std::move(bench));
+  }
+
+  uint32_t seed = std::random_device{}();
+  std::mt19937 rng(seed);
+  std::cout << "A/B: " << rounds << " rounds, seed " << seed << std::endl;
+
+  std::vector<size_t> order(k);
+  std::iota(order.begin(), order.end(), 0);
+  for (int64_t r = 0; r < rounds; r++) {
+    std::shuffle(order.begin(), order.end(), rng);
+    for (size_t i : order) {
+      Helper::set_state(states[i]);
+      instances[i]->run_timed(r);
+      states[i] = Helper::state();
+    }
+  }
+
+  for (size_t i = 0; i < k; i++) {
+    const auto &h = instances[i]->latency;
+    std::cout << "  " << benches[i].first
+              << ": mean=" << format_ns(std::llround(h.mean()))
+              << " p50=" << format_ns(h.percentile(50))
+              << " cv=" << std::fixed << std::setprecision(1)
+              << h.cv() * 100.0 << "%" << std::endl;
+  }
+
+  const auto &ref = instances[0]->timings;
+  for (size_t i = 1; i < k; i++) {
+    const auto &cur = instances[i]->timings;
+    std::vector<double> diffs, log_ratios;
+    for (size_t r = 0; r < ref.size(); r++) {
+      double a = static_cast<double>(std::max<int64_t>(ref[r], 1));
+      double b = static_cast<double>(std::max<int64_t>(cur[r], 1));
+      diffs.push_back(b - a);
+      log_ratios.push_back(std::log(b / a));
+    }
+    auto [diff, diff_hw] = mean_ci(diffs);
+    auto [lr, lr_hw] = mean_ci(log_ratios);
+
+    auto pct = [](double log_ratio) {
+      std::ostringstream out;
+      out << std::showpos << std::fixed << std::setprecision(2)
+          << (std::exp(log_ratio) - 1.0) * 100.0 << "%";
+      return out.str();
+    };
+    auto signed_ns = [](double ns) {
+      return (ns < 0.0 ? "-" : "+") + format_ns(std::llround(std::abs(ns)));
+    };
+    const char *verdict = lr - lr_hw > 0.0   ? "slower"
+                          : lr + lr_hw < 0.0 ? "faster"
+                                             : "no significant difference";
 
-std::string to_lower(const std::string &str) {
-  std::string result = str;
-  std::transform(result.begin(), result.end(), result.begin(),
-                 [](unsigned char c) { return std::tolower(c); });
-  return result;
+    std::cout << "  " << benches[i].first << " vs " << benches[0].first
+              << ": " << pct(lr) << " [" << pct(lr - lr_hw) << ", "
+              << pct(lr + lr_hw) << "] diff=" << signed_ns(diff) << " ["
+              << signed_ns(diff - diff_hw) << ", " << signed_ns(diff + diff_hw)
+              << "] " << verdict << std::endl;
+  }
 }
 
-void Benchmark::all(const std::string &single_bench,
-                    const std::string &config_file) {
-  double summary_time = 0.0;
-  int ok = 0;
-  int fails = 0;
-
-  std::unordered_map<std::string, std::function<std::unique_ptr<Benchmark>()>>
+const std::unordered_map<std::string, BenchFactory> &bench_registry() {
+  static const std::unordered_map<std::string, BenchFactory>
       available_benches = {
           {"CLBG::Pidigits", []() { return std::make_unique<Pidigits>(); }},
+          {"CLBG::PidigitsBinarySplit",
+           []() { return std::make_unique<PidigitsBinarySplit>(); }},
+          {"CLBG::PidigitsInPlace",
+           []() { return std::make_unique<PidigitsInPlace>(); }},
           {"Binarytrees::Obj",
            []() { return std::make_unique<BinarytreesObj>(); }},
           {"Binarytrees::Arena",
            []() { return std::make_unique<BinarytreesArena>(); }},
+          {"Binarytrees::Parallel",
+           []() { return std::make_unique<BinarytreesParallel>(); }},
+          {"Binarytrees::Pmr",
+           []() { return std::make_unique<BinarytreesPmr>(); }},
+          {"Binarytrees::Implicit",
+           []() { return std::make_unique<BinarytreesImplicit>(); }},
           {"Brainfuck::Array",
            []() { return std::make_unique<BrainfuckArray>(); }},
           {"Brainfuck::Recursion",
@@ -5017,23 +8751,56 @@ void Benchmark::all(const std::string &single_bench,
            []() { return std::make_unique<TemplateParse>(); }},
           {"CSV::Parse", []() { return std::make_unique<CsvParse>(); }},
       };
+  return available_benches;
+}
+
+void Benchmark::all(const std::string &single_bench) {
+  double summary_time = 0.0;
+  int ok = 0;
+  int fails = 0;
+  int regressions = 0;
+  int improvements = 0;
+
+  const auto &available_benches = bench_registry();
 
-  std::ifstream file(config_file);
-  if (!file.is_open()) {
-    std::cerr << "Cannot open config file: " << config_file << std::endl;
+  if (!OPTIONS.ab.empty()) {
+    std::vector<std::pair<std::string, BenchFactory>> benches;
+    for (const auto &name : OPTIONS.ab) {
+      auto it = available_benches.find(name);
+      if (it == available_benches.end()) {
+        std::cerr << "Unknown benchmark: " << name << std::endl;
+        std::exit(1);
+      }
+      benches.emplace_back(name, it->second);
+    }
+    run_ab(benches);
     return;
   }
 
-  auto json_array = json::array();
-  try {
-    file >> json_array;
-  } catch (const std::exception &e) {
-    std::cerr << "Error parsing JSON config: " << e.what() << std::endl;
-    return;
+  if (OPTIONS.stats) {
+    std::cout << "Startup: " << format_ns(STARTUP_NS) << " (config "
+              << format_ns(Config::load_ns()) << ", " << Config::all().size()
+              << " entries)" << std::endl;
   }
 
-  for (const auto &item : json_array) {
-    std::string bench_name = item["name"].get<std::string>();
+  auto tally = [&](const RunResult &result) {
+    if (result.ok) {
+      ok++;
+    } else {
+      fails++;
+    }
+    summary_time += result.seconds;
+    if (result.verdict == Baseline::REGRESSION) {
+      regressions++;
+    } else if (result.verdict == Baseline::IMPROVEMENT) {
+      improvements++;
+    }
+  };
+
+  std::vector<std::pair<std::string, BenchFactory>> scheduled;
+
+  for (const auto &section : Config::all()) {
+    const std::string &bench_name = section.name;
 
     if (!single_bench.empty() &&
         to_lower(bench_name).find(to_lower(single_bench)) ==
@@ -5043,73 +8810,462 @@ void Benchmark::all(const std::string &single_bench,
 
     auto it = available_benches.find(bench_name);
     if (it != available_benches.end()) {
+      if (OPTIONS.jobs > 0) {
+        scheduled.emplace_back(bench_name, it->second);
+        continue;
+      }
+
       std::cout << bench_name << ": ";
       std::cout.flush();
 
-      auto bench = it->second();
-      Helper::reset();
-      bench->prepare();
-      bench->warmup();
-      Helper::reset();
-
-      auto start = std::chrono::steady_clock::now();
-      bench->run_all();
-      auto end = std::chrono::steady_clock::now();
-
-      std::chrono::duration<double> duration = end - start;
-
-      uint32_t check = bench->checksum();
-      uint32_t expect = static_cast<uint32_t>(bench->expected_checksum());
-      if (check == expect) {
-        std::cout << "OK ";
-        ok++;
-      } else {
-        std::cout << "ERR[actual=" << check << ", expected=" << expect << "] ";
-        fails++;
+      if (!OPTIONS.sweep_field.empty()) {
+        run_sweep(bench_name, it->second);
+        continue;
+      }
+      if (OPTIONS.thread_sweep > 0) {
+        run_thread_sweep(it->second);
+        continue;
+      }
+      if (OPTIONS.rate > 0) {
+        tally(run_rate(it->second));
+        continue;
       }
 
-      std::cout << "in " << std::fixed << std::setprecision(3)
-                << duration.count() << "s" << std::endl;
-
-      summary_time += duration.count();
-
-      bench.reset();
-      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+      tally(OPTIONS.fork ? run_forked(it->second) : run_benchmark(it->second));
     } else {
       std::cout << "Warning: Benchmark '" << bench_name
                 << "' defined in config but not found in code" << std::endl;
     }
   }
 
+  if (!scheduled.empty()) {
+    for (const auto &result : run_concurrent(scheduled, OPTIONS.jobs)) {
+      tally(result);
+    }
+  }
+
   if (ok + fails > 0) {
     std::cout << "Summary: " << std::fixed << std::setprecision(4)
               << summary_time << "s, " << (ok + fails) << ", " << ok << ", "
               << fails << std::endl;
   }
 
-  if (fails > 0) {
+  if (!OPTIONS.baseline_path.empty()) {
+    std::cout << "Baseline: " << regressions << " regressions, "
+              << improvements << " improvements" << std::endl;
+  }
+
+  if (fails > 0 || regressions > 0) {
     std::exit(1);
   }
 }
 
+// Resident mode: accepts newline-delimited JSON requests on a Unix socket,
+// one client at a time, and answers each with JSON lines. A request looks
+// like
+//   {"name": "Sort::Quick", "config": {"size": 10000000},
+//    "iterations": 20, "warmup": 2, "stream": true}
+// where everything but "name" is optional; "config" overrides fields of the
+// benchmark's config section for this request only. With "stream" every
+// timed iteration is sent as it completes, followed by the "result" line.
+// {"cmd": "list"} returns the benchmark names and {"cmd": "quit"} stops the
+// server. Prepared inputs stay in memory between requests (PrepCache), so
+// repeated runs of the same configuration skip prepare().
+class Server {
+private:
+  int client = -1;
+
+  bool send(const json &reply) {
+    std::string line = reply.dump() + "\n";
+    size_t sent = 0;
+    while (sent < line.size()) {
+      ssize_t n = write(client, line.data() + sent, line.size() - sent);
+      if (n < 0 && errno == EINTR) {
+        continue;
+      }
+      if (n <= 0) {
+        return false;
+      }
+      sent += static_cast<size_t>(n);
+    }
+    return true;
+  }
+
+  bool error(const std::string &message) {
+    return send({{"event", "error"}, {"message", message}});
+  }
+
+  bool run(const json &request) {
+    std::string name = request["name"].get<std::string>();
+    const auto &registry = bench_registry();
+    auto it = registry.find(name);
+    if (it == registry.end()) {
+      return error("unknown benchmark: " + name);
+    }
+
+    json overrides = request.value("config", json::object());
+    if (!overrides.is_object()) {
+      return error("bad request: \"config\" must be an object");
+    }
+    if (request.contains("iterations")) {
+      overrides["iterations"] = request["iterations"];
+    }
+    if (request.contains("warmup")) {
+      overrides["warmup_iterations"] = request["warmup"];
+    }
+    bool stream = request.value("stream", false);
+
+    auto saved = Config::section(name).fields;
+    for (const auto &[field, value] : overrides.items()) {
+      auto converted = Config::from_json(value);
+      if (!converted) {
+        Config::section(name).fields = saved;
+        return error("bad request: config." + field + " must be a scalar");
+      }
+      Config::section(name).set(Config::key(field), *converted);
+    }
+
+    try {
+      bool connected = measure(name, it->second, stream);
+      Config::section(name).fields = saved;
+      return connected;
+    } catch (...) {
+      Config::section(name).fields = saved;
+      throw;
+    }
+  }
+
+  bool measure(const std::string &name, const BenchFactory &make,
+               bool stream) {
+    Helper::reset();
+    int64_t prepare_start = Helper::now_ns();
+    auto bench = make();
+    Helper::reset();
+    PrepCache::Status cache = prepare_cached(*bench);
+    int64_t warmup_start = Helper::now_ns();
+    bench->warmup();
+    Helper::reset();
+    int64_t warmup_end = Helper::now_ns();
+
+    bool connected = true;
+    int64_t iters = bench->iterations();
+    for (int64_t i = 0; i < iters && connected; i++) {
+      bench->run_timed(i);
+      if (stream) {
+        connected = send({{"event", "iteration"},
+                          {"name", name},
+                          {"i", i},
+                          {"ns", bench->timings.back()}});
+      }
+    }
+    int64_t run_end = Helper::now_ns();
+
+    uint32_t check = bench->checksum();
+    int64_t expect = bench->expected_checksum();
+    const auto &h = bench->latency;
+    json reply = {
+        {"event", "result"},
+        {"name", name},
+        {"config", Config::to_json(name)},
+        {"prepare", cache == PrepCache::HIT ? "hit" : "fresh"},
+        {"prepare_s", (warmup_start - prepare_start) / 1e9},
+        {"warmup_s", (warmup_end - warmup_start) / 1e9},
+        {"run_s", (run_end - warmup_end) / 1e9},
+        {"iterations", bench->timings.size()},
+        {"latency_ns",
+         {{"min", h.min()},
+          {"p50", h.percentile(50)},
+          {"p90", h.percentile(90)},
+          {"p99", h.percentile(99)},
+          {"max", h.max()},
+          {"mean", h.mean()},
+          {"cv", h.cv()}}},
+        {"checksum",
+         {{"ok", check == static_cast<uint32_t>(expect)},
+          {"actual", check},
+          {"expected", expect}}}};
+    return connected && send(reply);
+  }
+
+  // Returns false once the server should stop.
+  bool handle(const std::string &line) {
+    json request;
+    try {
+      request = json::parse(line);
+    } catch (const std::exception &e) {
+      error(std::string("bad request: ") + e.what());
+      return true;
+    }
+    if (!request.is_object()) {
+      error("bad request: expected an object");
+      return true;
+    }
+
+    std::string cmd = request.value("cmd", "run");
+    if (cmd == "quit") {
+      send({{"event", "bye"}});
+      return false;
+    }
+    if (cmd == "list") {
+      std::vector<std::string> names;
+      for (const auto &[name, make] : bench_registry()) {
+        names.push_back(name);
+      }
+      std::sort(names.begin(), names.end());
+      send({{"event", "list"}, {"names", names}});
+      return true;
+    }
+    if (cmd != "run" || !request.contains("name") ||
+        !request["name"].is_string()) {
+      error("bad request: expected {\"name\": ...} or a known \"cmd\"");
+      return true;
+    }
+
+    try {
+      run(request);
+    } catch (const std::exception &e) {
+      error(e.what());
+    }
+    return true;
+  }
+
+public:
+  int serve(const std::string &path) {
+    sockaddr_un addr{};
+    if (path.size() >= sizeof(addr.sun_path)) {
+      std::cerr << "Socket path too long: " << path << std::endl;
+      return 1;
+    }
+    addr.sun_family = AF_UNIX;
+    std::memcpy(addr.sun_path, path.c_str(), path.size() + 1);
+
+    int listener = socket(AF_UNIX, SOCK_STREAM, 0);
+    unlink(path.c_str());
+    if (listener < 0 ||
+        bind(listener, reinterpret_cast<sockaddr *>(&addr), sizeof(addr)) !=
+            0 ||
+        listen(listener, 16) != 0) {
+      std::cerr << "Cannot listen on " << path << ": " << std::strerror(errno)
+                << std::endl;
+      return 1;
+    }
+    std::signal(SIGPIPE, SIG_IGN);
+    PrepCache::keep_in_memory();
+    std::cout << "Listening on " << path << std::endl;
+
+    bool running = true;
+    while (running) {
+      client = accept(listener, nullptr, nullptr);
+      if (client < 0) {
+        if (errno == EINTR) {
+          continue;
+        }
+        break;
+      }
+
+      std::string pending;
+      char buf[4096];
+      ssize_t n;
+      while (running && (n = read(client, buf, sizeof(buf))) > 0) {
+        pending.append(buf, static_cast<size_t>(n));
+        size_t eol;
+        while (running && (eol = pending.find('\n')) != std::string::npos) {
+          std::string line = pending.substr(0, eol);
+          pending.erase(0, eol + 1);
+          if (!line.empty()) {
+            running = handle(line);
+          }
+        }
+      }
+      close(client);
+      client = -1;
+    }
+
+    close(listener);
+    unlink(path.c_str());
+    return 0;
+  }
+};
+
+// Parses all of `text` as a number; false on an empty value, trailing junk
+// or overflow, where std::stoi and friends would throw or stop early.
+template <typename T> bool parse_number(std::string_view text, T &out) {
+  const char *end = text.data() + text.size();
+  auto [ptr, ec] = std::from_chars(text.data(), end, out);
+  return !text.empty() && ec == std::errc() && ptr == end;
+}
+
+std::vector<std::string> parse_options(int argc, char *argv[]) {
+  std::vector<std::string> positional;
+  for (int i = 1; i < argc; i++) {
+    std::string arg = argv[i];
+    if (arg.rfind("--", 0) != 0) {
+      positional.push_back(arg);
+      continue;
+    }
+
+    auto invalid = [&arg]() {
+      std::cerr << "Invalid option value: " << arg << std::endl;
+      std::exit(1);
+    };
+
+    if (arg == "--stats") {
+      OPTIONS.stats = true;
+    } else if (arg == "--perf") {
+      OPTIONS.perf = true;
+    } else if (arg == "--fork") {
+      OPTIONS.fork = true;
+    } else if (arg.rfind("--json=", 0) == 0) {
+      OPTIONS.json_path = arg.substr(7);
+    } else if (arg.rfind("--csv=", 0) == 0) {
+      OPTIONS.csv_path = arg.substr(6);
+    } else if (arg.rfind("--baseline=", 0) == 0) {
+      OPTIONS.baseline_path = arg.substr(11);
+      if (OPTIONS.baseline_path.empty()) {
+        invalid();
+      }
+    } else if (arg.rfind("--samples=", 0) == 0) {
+      if (!parse_number(arg.substr(10), OPTIONS.min_samples) ||
+          OPTIONS.min_samples < 0) {
+        invalid();
+      }
+    } else if (arg == "--adaptive") {
+      OPTIONS.adaptive = true;
+    } else if (arg.rfind("--target-ci=", 0) == 0) {
+      if (!parse_number(arg.substr(12), OPTIONS.target_ci) ||
+          OPTIONS.target_ci <= 0.0) {
+        invalid();
+      }
+      OPTIONS.target_ci /= 100.0;
+    } else if (arg.rfind("--budget=", 0) == 0) {
+      if (!parse_number(arg.substr(9), OPTIONS.budget) ||
+          OPTIONS.budget <= 0.0) {
+        invalid();
+      }
+    } else if (arg.rfind("--threads=", 0) == 0) {
+      if (!parse_number(arg.substr(10), OPTIONS.threads) ||
+          OPTIONS.threads < 1) {
+        invalid();
+      }
+    } else if (arg == "--thread-sweep") {
+      OPTIONS.thread_sweep =
+          std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+    } else if (arg.rfind("--thread-sweep=", 0) == 0) {
+      if (!parse_number(arg.substr(15), OPTIONS.thread_sweep) ||
+          OPTIONS.thread_sweep < 1) {
+        invalid();
+      }
+    } else if (arg.rfind("--rate=", 0) == 0) {
+      if (!parse_number(arg.substr(7), OPTIONS.rate) || OPTIONS.rate < 1) {
+        invalid();
+      }
+    } else if (arg == "--jobs") {
+      OPTIONS.jobs = static_cast<int>(physical_cores().size());
+    } else if (arg.rfind("--jobs=", 0) == 0) {
+      if (!parse_number(arg.substr(7), OPTIONS.jobs) || OPTIONS.jobs < 1) {
+        invalid();
+      }
+    } else if (arg.rfind("--trace=", 0) == 0) {
+      OPTIONS.trace_path = arg.substr(8);
+    } else if (arg.rfind("--profile=", 0) == 0) {
+      OPTIONS.profile_dir = arg.substr(10);
+    } else if (arg.rfind("--cache=", 0) == 0) {
+      OPTIONS.cache_dir = arg.substr(8);
+    } else if (arg.rfind("--serve=", 0) == 0) {
+      OPTIONS.serve_path = arg.substr(8);
+    } else if (arg.rfind("--isa=", 0) == 0) {
+      if (!Isa::force(arg.substr(6))) {
+        std::exit(1);
+      }
+      std::cout << "isa: " << Isa::name(Isa::active()) << " (detected "
+                << Isa::name(Isa::detected()) << ")" << std::endl;
+    } else if (arg.rfind("--ab=", 0) == 0) {
+      std::istringstream spec(arg.substr(5));
+      std::string name;
+      while (std::getline(spec, name, ',')) {
+        OPTIONS.ab.push_back(name);
+      }
+      if (OPTIONS.ab.size() < 2) {
+        std::cerr << "Expected --ab=A,B[,...]" << std::endl;
+        std::exit(1);
+      }
+    } else if (arg.rfind("--sweep=", 0) == 0) {
+      // --sweep=field:from:to[:factor]
+      std::istringstream spec(arg.substr(8));
+      std::string part;
+      std::vector<std::string> parts;
+      while (std::getline(spec, part, ':')) {
+        parts.push_back(part);
+      }
+      if (parts.size() < 3 || parts.size() > 4) {
+        std::cerr << "Expected --sweep=field:from:to[:factor]" << std::endl;
+        std::exit(1);
+      }
+      OPTIONS.sweep_field = parts[0];
+      double from = 0.0;
+      double to = 0.0;
+      if (!parse_number(parts[1], from) || !parse_number(parts[2], to) ||
+          (parts.size() == 4 &&
+           !parse_number(parts[3], OPTIONS.sweep_factor))) {
+        invalid();
+      }
+      OPTIONS.sweep_from = std::llround(from);
+      OPTIONS.sweep_to = std::llround(to);
+      if (OPTIONS.sweep_from <= 0 || OPTIONS.sweep_factor <= 1.0) {
+        std::cerr << "Sweep needs from > 0 and factor > 1" << std::endl;
+        std::exit(1);
+      }
+    } else if (arg == "--alloc") {
+      OPTIONS.alloc = true;
+      AllocStats::enable();
+      mp_set_memory_functions(gmp_alloc, gmp_realloc, gmp_free);
+    } else {
+      std::cerr << "Unknown option: " << arg << std::endl;
+      std::exit(1);
+    }
+  }
+  return positional;
+}
+
 int main(int argc, char *argv[]) {
+  int64_t main_start = Helper::now_ns();
   auto now = std::chrono::duration_cast<std::chrono::milliseconds>(
                  std::chrono::system_clock::now().time_since_epoch())
                  .count();
   std::cout << "start: " << now << std::endl;
 
-  std::string config_file = "../test.js";
-  if (argc > 1) {
-    config_file = argv[1];
-    load_config(argv[1]);
-  } else {
-    load_config();
+  auto args = parse_options(argc, argv);
+  if (!RESULTS.open(OPTIONS.json_path, OPTIONS.csv_path)) {
+    return 1;
+  }
+  if (!OPTIONS.trace_path.empty() && !Tracer::open(OPTIONS.trace_path)) {
+    return 1;
+  }
+  if (!OPTIONS.cache_dir.empty() && !PrepCache::open(OPTIONS.cache_dir)) {
+    return 1;
+  }
+  if (!OPTIONS.baseline_path.empty()) {
+    if (!Baseline::load(OPTIONS.baseline_path)) {
+      return 1;
+    }
+    if (OPTIONS.min_samples == 0) {
+      OPTIONS.min_samples = Baseline::DEFAULT_SAMPLES;
+    }
+  }
+
+  if (!Config::load(args.size() > 0 ? args[0] : "../test.js")) {
+    return 1;
+  }
+  STARTUP_NS = Helper::now_ns() - main_start;
+
+  if (!OPTIONS.serve_path.empty()) {
+    return Server().serve(OPTIONS.serve_path);
   }
 
-  if (argc > 2) {
-    Benchmark::all(argv[2], config_file);
+  if (args.size() > 1) {
+    Benchmark::all(args[1]);
   } else {
-    Benchmark::all("", config_file);
+    Benchmark::all();
   }
 
   std::ofstream file("/tmp/recompile_marker");
@@ -5119,4 +9275,4 @@ int main(int argc, char *argv[]) {
   }
 
   return 0;
-}
\ No newline at end of file
+}
@@ -11,6 +11,25 @@
     "depth": 20,
     "iterations": 30
   },
+  {
+    "name": "Binarytrees::Parallel",
+    "checksum": 75497436,
+    "depth": 20,
+    "cutoff": 10,
+    "iterations": 30
+  },
+  {
+    "name": "Binarytrees::Pmr",
+    "checksum": 75497436,
+    "depth": 20,
+    "iterations": 30
+  },
+  {
+    "name": "Binarytrees::Implicit",
+    "checksum": 75497436,
+    "depth": 20,
+    "iterations": 30
+  },
   {
     "name": "Brainfuck::Array",
     "checksum": 954437102,
@@ -237,6 +256,18 @@
     "amount": 1000,
     "iterations": 120
   },
+  {
+    "name": "CLBG::PidigitsBinarySplit",
+    "checksum": 83118357,
+    "amount": 50000,
+    "iterations": 20
+  },
+  {
+    "name": "CLBG::PidigitsInPlace",
+    "checksum": 3205646197,
+    "amount": 1000,
+    "iterations": 120
+  },
   {
     "name": "CLBG::Fannkuchredux",
     "checksum": 135762480,
@@ -11,6 +11,25 @@
     "depth": 4,
     "iterations": 3
   },
+  {
+    "name": "Binarytrees::Parallel",
+    "checksum": 124,
+    "depth": 4,
+    "cutoff": 2,
+    "iterations": 3
+  },
+  {
+    "name": "Binarytrees::Pmr",
+    "checksum": 124,
+    "depth": 4,
+    "iterations": 3
+  },
+  {
+    "name": "Binarytrees::Implicit",
+    "checksum": 124,
+    "depth": 4,
+    "iterations": 3
+  },
   {
     "name": "Brainfuck::Array",
     "checksum": 3562897308,
@@ -237,6 +256,18 @@
     "amount": 10,
     "iterations": 3
   },
+  {
+    "name": "CLBG::PidigitsBinarySplit",
+    "checksum": 1602634137,
+    "amount": 10,
+    "iterations": 3
+  },
+  {
+    "name": "CLBG::PidigitsInPlace",
+    "checksum": 1602634137,
+    "amount": 10,
+    "iterations": 3
+  },
   {
     "name": "CLBG::Fannkuchredux",
     "checksum": 4428,